@@ -0,0 +1,358 @@
+//
+// Created by Anton on 17.10.2026.
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "BuildError.h"
+#include "DGen.h"
+
+//runs every program of the examples directory and the generated stress programs
+//through the whole DGen pipeline and prints the results as json to stdout.
+//every program is run in its own process, so its peak rss isn't shadowed by the previous ones
+
+struct BenchProgram {
+	std::string name;
+	std::string source;
+};
+
+static int tests_num = 1000;
+static int seed = 1;
+static int threads = 1;
+static std::string examples_dir = "examples";
+static ProgramOptions options;
+
+static std::string json_str(const std::string &str) {
+	std::string res = "\"";
+	for (char c: str) {
+		switch (c) {
+			case '"':
+				res += "\\\"";
+				break;
+			case '\\':
+				res += "\\\\";
+				break;
+			case '\n':
+				res += "\\n";
+				break;
+			case '\t':
+				res += "\\t";
+				break;
+			default:
+				if ((unsigned char)c < 0x20) {
+					char buf[8];
+					snprintf(buf, sizeof(buf), "\\u%04x", (unsigned)(unsigned char)c);
+					res += buf;
+				} else {
+					res += c;
+				}
+		}
+	}
+	return res + "\"";
+}
+
+static std::string indent(int level) {
+	return std::string(level, '\t');
+}
+
+//depth nested loops of 3 iterations with a condition on the input in the innermost one
+static std::string loop_nest(int depth) {
+	std::ostringstream out;
+	out << "int loop_nest_" << depth << "(int n) {\n\tint s = 0\n";
+	for (int i = 0; i < depth; i++) {
+		out << "\tint i" << i << "\n";
+	}
+	for (int i = 0; i < depth; i++) {
+		out << indent(i + 1) << "for i" << i << " = 0; i" << i << " < 3; i" << i << "++ {\n";
+	}
+	out << indent(depth + 1) << "[prob = 50;]\n"
+		<< indent(depth + 1) << "if n > s {\n"
+		<< indent(depth + 2) << "s++\n"
+		<< indent(depth + 1) << "}\n";
+	for (int i = depth - 1; i >= 0; i--) {
+		out << indent(i + 1) << "}\n";
+	}
+	out << "\treturn s\n}\n";
+	return out.str();
+}
+
+//len ifs whose preconditions tie every input to the previous one
+static std::string precond_chain(int len) {
+	std::ostringstream out;
+	out << "int precond_chain_" << len << "(";
+	for (int i = 0; i < len; i++) {
+		out << (i ? ", " : "") << "int a" << i;
+	}
+	out << ") {\n\tint s = 0\n";
+	for (int i = 0; i < len; i++) {
+		out << "\t[prob = 80; a" << i << (i ? " > a" + std::to_string(i - 1) : std::string(" > 0")) << "]\n"
+			<< "\tif a" << i << " < " << (i + 1) * 100 << " {\n"
+			<< "\t\ts++\n"
+			<< "\t}\n";
+	}
+	out << "\treturn s\n}\n";
+	return out.str();
+}
+
+//sum of all the elements of a dims dimensional input array
+static std::string nested_arrays(int dims) {
+	std::ostringstream out;
+	auto arr_type = [](int dims) {
+		std::string res = "int";
+		for (int i = 0; i < dims; i++) {
+			res += "[]";
+		}
+		return res;
+	};
+	out << "int nested_arrays_" << dims << "(" << arr_type(dims) << " m0) {\n\tint s = 0\n";
+	for (int i = 0; i < dims; i++) {
+		out << "\tint i" << i << "\n";
+	}
+	for (int i = 0; i < dims; i++) {
+		out << indent(i + 1) << "for i" << i << " = 0; i" << i << " < m" << i << ".len; i" << i << "++ {\n";
+		if (i + 1 < dims) {
+			out << indent(i + 2) << arr_type(dims - i - 1) << " m" << i + 1 << " = m" << i << "[i" << i << "]\n";
+		}
+	}
+	out << indent(dims + 1) << "s += m" << dims - 1 << "[i" << dims - 1 << "]\n";
+	for (int i = dims - 1; i >= 0; i--) {
+		out << indent(i + 1) << "}\n";
+	}
+	out << "\treturn s\n}\n";
+	return out.str();
+}
+
+//stmts straight line statements, every 10th one is an if
+static std::string long_body(int stmts) {
+	std::ostringstream out;
+	out << "int long_body_" << stmts << "(int n) {\n\tint s = n\n";
+	for (int i = 0; i < stmts; i++) {
+		if (i % 10 == 9) {
+			out << "\tif s > " << i << " {\n\t\ts -= " << i << "\n\t}\n";
+		} else {
+			out << "\ts += " << i % 7 + 1 << "\n";
+		}
+	}
+	out << "\treturn s\n}\n";
+	return out.str();
+}
+
+static std::vector<BenchProgram> collect_programs() {
+	std::vector<BenchProgram> programs;
+
+	std::vector<std::filesystem::path> paths;
+	std::error_code ec;
+	for (const auto &entry: std::filesystem::directory_iterator(examples_dir, ec)) {
+		if (entry.path().extension() == ".dg") {
+			paths.push_back(entry.path());
+		}
+	}
+	if (ec) {
+		std::cerr << "warning: can't read " << examples_dir << ": " << ec.message() << std::endl;
+	}
+	std::sort(paths.begin(), paths.end());
+	for (const auto &path: paths) {
+		std::ifstream in(path);
+		std::stringstream source;
+		source << in.rdbuf();
+		programs.push_back({"examples/" + path.filename().string(), source.str()});
+	}
+
+	for (int depth: {2, 4, 6}) {
+		programs.push_back({"stress/loop_nest_" + std::to_string(depth), loop_nest(depth)});
+	}
+	for (int len: {8, 32, 128}) {
+		programs.push_back({"stress/precond_chain_" + std::to_string(len), precond_chain(len)});
+	}
+	for (int dims: {2, 3, 4}) {
+		programs.push_back({"stress/nested_arrays_" + std::to_string(dims), nested_arrays(dims)});
+	}
+	for (int stmts: {1000, 5000}) {
+		programs.push_back({"stress/long_body_" + std::to_string(stmts), long_body(stmts)});
+	}
+	return programs;
+}
+
+//counts the output instead of keeping it
+class CountingSink: public Sink {
+public:
+	size_t bytes = 0;
+	void write(const char *data, size_t size) override {
+		bytes += size;
+	}
+	using Sink::write;
+};
+
+static double ms(uint64_t ns) {
+	return (double)ns / 1e6;
+}
+
+//json fields of the run of the program (without the braces)
+static std::string run_program(const BenchProgram &program) {
+	using clock = std::chrono::steady_clock;
+	std::ostringstream out;
+	try {
+		std::istringstream stream(program.source);
+		auto build_start = clock::now();
+		DGen d_gen(stream, options);
+		//the level of -Oauto is picked for the number of tests as in generate_json
+		auto &compiled = d_gen.compile(tests_num);
+		auto build_end = clock::now();
+
+		CountingSink sink;
+		d_gen.generate_json(tests_num, seed, sink, threads);
+		auto gen_end = clock::now();
+
+		auto build_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(build_end - build_start).count();
+		auto gen_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(gen_end - build_end).count();
+		auto phases = compiled.phase_times();
+		auto cache = compiled.solver_cache_stats();
+
+		out << "\"build_ms\": " << ms(build_ns)
+			<< ", \"generate_ms\": " << ms(gen_ns)
+			<< ", \"tests_per_sec\": " << (gen_ns ? tests_num / (gen_ns / 1e9) : 0)
+			<< ", \"output_bytes\": " << sink.bytes
+			<< ", \"parse_mb_per_sec\": " << (phases.parse_ns ? program.source.size() / (phases.parse_ns / 1e3) : 0)
+			<< ", \"solver_cache_hits\": " << cache.hits
+			<< ", \"solver_cache_misses\": " << cache.misses
+			<< ", \"phases_ms\": {"
+			<< "\"parse\": " << ms(phases.parse_ns)
+			<< ", \"semantics\": " << ms(phases.semantics_ns)
+			<< ", \"codegen\": " << ms(phases.codegen_ns)
+			<< ", \"optimize\": " << ms(phases.optimize_ns)
+			<< ", \"jit\": " << ms(phases.jit_ns)
+			<< ", \"execute\": " << ms(phases.execute_ns)
+			<< ", \"solve\": " << ms(phases.solve_ns)
+			<< ", \"serialize\": " << ms(phases.serialize_ns)
+			<< "}";
+	} catch (const BuildError &err) {
+		std::string msg;
+		for (const auto &e: err.errors) {
+			msg += (msg.empty() ? "" : "; ") + std::to_string(e.pos.line) + ":" + std::to_string(e.pos.col) + " " + e.msg;
+		}
+		out.str("");
+		out << "\"error\": " << json_str(msg);
+	} catch (const std::exception &err) {
+		out.str("");
+		out << "\"error\": " << json_str(err.what());
+	}
+	return out.str();
+}
+
+//the fields of the run in the child process with its peak rss
+static std::string run_isolated(const BenchProgram &program) {
+	int fds[2];
+	if (pipe(fds) != 0) {
+		return "\"error\": \"pipe failed\"";
+	}
+	std::cout.flush();
+	pid_t pid = fork();
+	if (pid < 0) {
+		close(fds[0]);
+		close(fds[1]);
+		return "\"error\": \"fork failed\"";
+	}
+	if (pid == 0) {
+		close(fds[0]);
+		auto res = run_program(program);
+		size_t written = 0;
+		while (written < res.size()) {
+			auto n = ::write(fds[1], res.data() + written, res.size() - written);
+			if (n <= 0) {
+				_exit(1);
+			}
+			written += n;
+		}
+		_exit(0);
+	}
+
+	close(fds[1]);
+	std::string res;
+	char buf[4096];
+	ssize_t n;
+	while ((n = read(fds[0], buf, sizeof(buf))) > 0) {
+		res.append(buf, n);
+	}
+	close(fds[0]);
+
+	int status;
+	rusage usage{};
+	wait4(pid, &status, 0, &usage);
+	if (WIFSIGNALED(status)) {
+		return "\"error\": " + json_str(std::string("killed by signal ") + strsignal(WTERMSIG(status)));
+	}
+	if (res.empty()) {
+		res = "\"error\": \"no result\"";
+	}
+	//kilobytes on linux
+	return res + ", \"peak_rss_kb\": " + std::to_string(usage.ru_maxrss);
+}
+
+static void parse_args(int argc, char *argv[]) {
+	for (int i = 1; i < argc; i++) {
+		switch (argv[i][1]) {
+			case 'n':
+				tests_num = std::atoi(argv[i]+2);
+				break;
+			case 's':
+				seed = std::atoi(argv[i]+2);
+				break;
+			case 'j':
+				threads = std::atoi(argv[i]+2);
+				break;
+			case 'x':
+				examples_dir = argv[i]+2;
+				break;
+			case 'O':
+				if (argv[i][2] >= '0' && argv[i][2] <= '3' && argv[i][3] == '\0') {
+					options.opt_level = (OptLevel)(argv[i][2] - '0');
+				} else if (std::strcmp(argv[i]+2, "auto") == 0) {
+					options.opt_level = OptLevel::AUTO;
+				}
+				break;
+			case 'e':
+				if (std::strcmp(argv[i]+2, "interp") == 0) {
+					options.exec_mode = ExecMode::INTERPRETER;
+				}
+				break;
+			case 'h':
+				std::cerr << "usage: " << argv[0] << " -n<tests, 1000> -s<seed, 1> -j<threads, 1> "
+						  << "-x<examples dir, examples> -O<0|1|2|3|auto, auto> -e<optional interp>" << std::endl;
+				exit(0);
+			default:
+				std::cerr << "warning: unknown parameter " << argv[i] << std::endl;
+				break;
+		}
+	}
+}
+
+int main(int argc, char *argv[]) {
+	parse_args(argc, argv);
+	options.collect_phase_times = true;
+	DGen::init_backend();
+
+	auto programs = collect_programs();
+	std::cout << "{\n\t\"tests_num\": " << tests_num << ", \"seed\": " << seed << ", \"threads\": " << threads
+			  << ",\n\t\"programs\": [\n";
+	for (size_t i = 0; i < programs.size(); i++) {
+		std::cerr << "running " << programs[i].name << std::endl;
+		std::cout << "\t\t{\"name\": " << json_str(programs[i].name) << ", " << run_isolated(programs[i]) << "}"
+				  << (i + 1 < programs.size() ? ",\n" : "\n");
+	}
+	std::cout << "\t]\n}" << std::endl;
+	return 0;
+}
@@ -0,0 +1,331 @@
+//
+// Created by Anton on 17.10.2026.
+//
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <sstream>
+
+#include <benchmark/benchmark.h>
+
+#include "ASTArena.h"
+#include "ASTBuilderVisitor.h"
+#include "BuildError.h"
+#include "CodegenVisitor.h"
+#include "CodegenZ3Visitor.h"
+#include "Runtime.h"
+#include "Semantics.h"
+#include "Serializer.h"
+#include "Symbol.h"
+#include "ast.h"
+
+extern "C" uint8_t *arr_rand_gen(ArraySym *arr, Runtime *rt);
+extern "C" int32_t num_rand_gen(NumberSym *sym, Runtime *rt);
+extern "C" int8_t char_rand_gen(CharSym *sym, Runtime *rt);
+extern "C" void get_val_arr(ArraySym *arr, int *idxs, int len, uint8_t *dest, Runtime *rt);
+extern "C" uint32_t get_property(PropertyLookupNode *node, Runtime *rt);
+extern "C" uint8_t *create_arr(int32_t len, uint32_t pointed_sizeof, Runtime *rt);
+
+//operator new calls of the process (the library included), z3 allocates with malloc and isn't counted
+static std::atomic<uint64_t> allocs{0};
+
+void *operator new(size_t size) {
+	allocs.fetch_add(1, std::memory_order_relaxed);
+	if (void *ptr = std::malloc(size ? size : 1)) {
+		return ptr;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept {
+	std::free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept {
+	std::free(ptr);
+}
+
+//reports allocs/op of the benchmark loop, created right before it
+class AllocCounter {
+public:
+	explicit AllocCounter(benchmark::State &state): state(state), start(allocs.load()) {}
+	~AllocCounter() {
+		state.counters["allocs/op"] = benchmark::Counter((double)(allocs.load() - start),
+														 benchmark::Counter::kAvgIterations);
+	}
+private:
+	benchmark::State &state;
+	uint64_t start;
+};
+
+//inputs by position: n, c, a, s
+static const char *BENCH_SOURCE = R"(int bench(int n, char c, int[] a, string s) {
+	[prob = 70; n > -50]
+	if n * 3 + 7 < 100 && c != 'a' {
+		return 1
+	}
+	[prob = 50;]
+	if s.len > 3 {
+		return s.len
+	}
+	return a.len
+}
+)";
+
+//stmts straight line statements with an if with a precondition every 10th one
+static std::string long_source(int stmts) {
+	std::ostringstream out;
+	out << "int long_source(int n, int[] a) {\n\tint s = n\n";
+	for (int i = 0; i < stmts; i++) {
+		if (i % 10 == 9) {
+			out << "\t[prob = 50; n > " << i << "]\n\tif s * 2 > " << i << " && a.len < 5 {\n\t\ts -= " << i << "\n\t}\n";
+		} else {
+			out << "\ts += n * " << i % 7 + 1 << " - 1\n";
+		}
+	}
+	out << "\treturn s\n}\n";
+	return out.str();
+}
+
+//the program is parsed and its ir is generated as in CompiledProgram::build_ir,
+//so the symbols and nodes have everything the callbacks expect (nothing is compiled)
+class BenchProgram {
+public:
+	Runtime rt;
+	ASTArena ast_arena;
+	FunctionNode *func;
+	std::vector<std::shared_ptr<Symbol>> inputs;
+	std::unique_ptr<CodegenVisitor> visitor;
+	std::vector<IfNode*> ifs;
+
+	explicit BenchProgram(const std::string &source) {
+		ASTArena::Scope scope(ast_arena);
+		std::istringstream stream(source);
+		ASTBuilderVisitor builder(stream);
+		func = builder.parse();
+		Semantics sem(func);
+		sem.connect_loops();
+		inputs = sem.type_ast();
+		sem.type_check();
+		sem.eliminate_unreachable_code();
+
+		//gather_res isn't called, so there is no program
+		visitor = std::make_unique<CodegenVisitor>(nullptr, &rt, ProgramOptions());
+		visitor->code_gen(func);
+		visitor->get_z3_visitor()->reset();
+		rt.rng->seed(1, 0);
+
+		for (auto stmt: func->body->stmts) {
+			if (auto if_node = node_cast<IfNode>(stmt)) {
+				ifs.push_back(if_node);
+			}
+		}
+	}
+
+	~BenchProgram() {
+		visitor.reset();
+		inputs.clear();
+	}
+
+	template<class T>
+	T *input(int idx) {
+		return dynamic_cast<T*>(inputs[idx].get());
+	}
+
+	//the same as CompiledProgram::reset between the tests
+	void reset() {
+		rt.arena.reset();
+		for (auto &in: inputs) {
+			in->reset_val();
+		}
+	}
+};
+
+//the source to the ast, range(0) is the number of the statements of long_source (0 - BENCH_SOURCE),
+//the bytes/s counter is the parse throughput
+static void BM_parse(benchmark::State &state) {
+	auto source = state.range(0) ? long_source((int)state.range(0)) : std::string(BENCH_SOURCE);
+	AllocCounter counter(state);
+	for (auto _: state) {
+		ASTArena ast_arena;
+		ASTArena::Scope scope(ast_arena);
+		std::istringstream stream(source);
+		ASTBuilderVisitor builder(stream);
+		try {
+			benchmark::DoNotOptimize(builder.parse());
+		} catch (const BuildError &err) {
+			//fails this benchmark only
+			auto &e = err.errors.front();
+			state.SkipWithError((std::to_string(e.pos.line) + ":" + std::to_string(e.pos.col) + " " + e.msg).c_str());
+			break;
+		}
+	}
+	state.SetBytesProcessed(state.iterations() * (int64_t)source.size());
+}
+BENCHMARK(BM_parse)->Arg(0)->Arg(1000)->Arg(10000)->Unit(benchmark::kMicrosecond);
+
+static void BM_num_rand_gen(benchmark::State &state) {
+	BenchProgram p(BENCH_SOURCE);
+	auto sym = p.input<NumberSym>(0);
+	AllocCounter counter(state);
+	for (auto _: state) {
+		sym->reset_val();
+		benchmark::DoNotOptimize(num_rand_gen(sym, &p.rt));
+	}
+}
+BENCHMARK(BM_num_rand_gen);
+
+static void BM_char_rand_gen(benchmark::State &state) {
+	BenchProgram p(BENCH_SOURCE);
+	auto sym = p.input<CharSym>(1);
+	AllocCounter counter(state);
+	for (auto _: state) {
+		sym->reset_val();
+		benchmark::DoNotOptimize(char_rand_gen(sym, &p.rt));
+	}
+}
+BENCHMARK(BM_char_rand_gen);
+
+//the whole array is generated, then released with the test
+static void BM_arr_rand_gen(benchmark::State &state) {
+	BenchProgram p(BENCH_SOURCE);
+	auto arr = p.input<ArraySym>(2);
+	AllocCounter counter(state);
+	for (auto _: state) {
+		benchmark::DoNotOptimize(arr_rand_gen(arr, &p.rt));
+		p.reset();
+	}
+}
+BENCHMARK(BM_arr_rand_gen);
+
+//lookups of the elements of an array of a fixed size, the first touch of an element generates it
+static void BM_get_val_arr(benchmark::State &state) {
+	BenchProgram p(BENCH_SOURCE);
+	auto arr = p.input<ArraySym>(2);
+	while (arr->get_size(*p.rt.rng) == 0) {
+		arr->reset_val();
+	}
+	int size = arr->get_size(*p.rt.rng);
+	int idx = 0;
+	int32_t val;
+	AllocCounter counter(state);
+	for (auto _: state) {
+		get_val_arr(arr, &idx, 1, reinterpret_cast<uint8_t*>(&val), &p.rt);
+		benchmark::DoNotOptimize(val);
+		idx = (idx + 1) % size;
+	}
+}
+BENCHMARK(BM_get_val_arr);
+
+//s.len of the second condition
+static void BM_get_property(benchmark::State &state) {
+	BenchProgram p(BENCH_SOURCE);
+	auto cond = node_cast<BinOpNode>(p.ifs[1]->cond);
+	auto node = node_cast<PropertyLookupNode>(cond->lhs);
+	AllocCounter counter(state);
+	for (auto _: state) {
+		benchmark::DoNotOptimize(get_property(node, &p.rt));
+		p.reset();
+	}
+}
+BENCHMARK(BM_get_property);
+
+//local arrays of range(0) ints created by a test and released by the reset
+static void BM_create_arr_reset(benchmark::State &state) {
+	BenchProgram p(BENCH_SOURCE);
+	auto len = (int32_t)state.range(0);
+	AllocCounter counter(state);
+	for (auto _: state) {
+		for (int i = 0; i < 8; i++) {
+			benchmark::DoNotOptimize(create_arr(len, sizeof(int32_t), &p.rt));
+		}
+		p.reset();
+	}
+}
+BENCHMARK(BM_create_arr_reset)->Arg(16)->Arg(1024);
+
+//the same as CompiledProgram::gather_res: every input of a generated test is serialized to its cell,
+//range(0) is the OutputFormat
+static void BM_gather_res(benchmark::State &state) {
+	BenchProgram p(BENCH_SOURCE);
+	std::vector<Serializer::Column> columns;
+	for (const auto &in: p.inputs) {
+		columns.push_back({in->name, in->type});
+	}
+	columns.push_back({p.func->name, p.func->ret_type});
+	auto serializer = Serializer::create((OutputFormat)state.range(0), std::move(columns));
+	ValuePlan result_plan(p.func->ret_type);
+	std::vector<std::string> cells(p.inputs.size() + 1);
+	int32_t res = 42;
+	AllocCounter counter(state);
+	for (auto _: state) {
+		for (size_t i = 0; i < p.inputs.size(); i++) {
+			cells[i].clear();
+			p.inputs[i]->serialize(p.rt, *serializer, cells[i]);
+		}
+		cells.back().clear();
+		result_plan.write(*serializer, cells.back(), reinterpret_cast<const uint8_t*>(&res));
+		benchmark::DoNotOptimize(cells.data());
+		p.reset();
+	}
+}
+BENCHMARK(BM_gather_res)
+		->Arg((int)OutputFormat::JSON)->Arg((int)OutputFormat::BINARY)->Arg((int)OutputFormat::COLUMNAR);
+
+//a block of TESTS_BLOCK_SIZE tests is assembled from the cells, range(0) is the OutputFormat
+static void BM_write_block(benchmark::State &state) {
+	BenchProgram p(BENCH_SOURCE);
+	std::vector<Serializer::Column> columns;
+	for (const auto &in: p.inputs) {
+		columns.push_back({in->name, in->type});
+	}
+	columns.push_back({p.func->name, p.func->ret_type});
+	auto serializer = Serializer::create((OutputFormat)state.range(0), std::move(columns));
+
+	std::vector<std::vector<std::string>> tests(64);
+	for (auto &cells: tests) {
+		cells.resize(p.inputs.size() + 1);
+		for (size_t i = 0; i < p.inputs.size(); i++) {
+			p.inputs[i]->serialize(p.rt, *serializer, cells[i]);
+		}
+		serializer->write_int(cells.back(), 1);
+		p.reset();
+	}
+
+	std::string out;
+	AllocCounter counter(state);
+	for (auto _: state) {
+		out.clear();
+		serializer->write_block(out, tests);
+		benchmark::DoNotOptimize(out.data());
+	}
+	state.SetItemsProcessed(state.iterations() * (int64_t)tests.size());
+}
+BENCHMARK(BM_write_block)
+		->Arg((int)OutputFormat::JSON)->Arg((int)OutputFormat::BINARY)->Arg((int)OutputFormat::COLUMNAR);
+
+//z3_gen of the condition range(0) (0 - int and char arithmetic with a precondition, 1 - length of a string),
+//the z3 context is reset every range(1) tests as in generate_block, so 1 is a cold solver every time
+//and 64 is a block where the most of the queries come from the solutions cache
+static void BM_start_z3_gen(benchmark::State &state) {
+	BenchProgram p(BENCH_SOURCE);
+	auto node = p.ifs[state.range(0)];
+	auto z3_visitor = p.visitor->get_z3_visitor();
+	auto reset_every = state.range(1);
+	int64_t tests = 0;
+	AllocCounter counter(state);
+	for (auto _: state) {
+		if (tests++ % reset_every == 0) {
+			z3_visitor->reset();
+		}
+		z3_gen(z3_visitor, node->cond, node->precond);
+		p.reset();
+	}
+	auto cache = z3_visitor->get_cache_stats();
+	state.counters["cache hit rate"] = cache.hits + cache.misses
+			? (double)cache.hits / (double)(cache.hits + cache.misses) : 0;
+}
+BENCHMARK(BM_start_z3_gen)->ArgsProduct({{0, 1}, {1, 64}})->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,123 @@
+//
+// Created by Anton on 17.10.2026.
+//
+
+#ifndef D_GEN_COMPILEDPROGRAM_H
+#define D_GEN_COMPILEDPROGRAM_H
+
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <optional>
+#include <istream>
+#include <string>
+
+#include "Options.h"
+#include "Sink.h"
+#include "Stats.h"
+
+class CodegenVisitor;
+class FunctionNode;
+class Symbol;
+class DGenJIT;
+class ObjectCache;
+class Serializer;
+class ValuePlan;
+class Interpreter;
+class ASTArena;
+struct Runtime;
+
+extern "C" void gather_res(CodegenVisitor *visitor, void *res);
+
+//program that is parsed, checked and jit compiled once
+//and can be used to generate tests many times
+class CompiledProgram {
+public:
+	explicit CompiledProgram(std::istream &input, ProgramOptions options = ProgramOptions());
+	~CompiledProgram();
+
+	//the slot table of the generated code keeps pointers to this object
+	CompiledProgram(const CompiledProgram&) = delete;
+	CompiledProgram &operator=(const CompiledProgram&) = delete;
+
+	//with threads > 1 tests are generated by several workers,
+	//the result for the given seed doesn't depend on the number of threads
+	std::string generate(int tests_num, std::optional<int> seed = std::optional<int>(), int threads = 1);
+	//the same output written to the sink while the tests are generated,
+	//only a few blocks of tests per thread are kept in memory
+	void generate(int tests_num, std::optional<int> seed, Sink &sink, int threads = 1);
+	//the same test as generate(n, seed) returns at test_idx position (n > test_idx),
+	//throws if the test is dropped
+	std::string generate_test(int test_idx, int seed);
+	//solutions cache counters of all the runs (summed over the workers)
+	SolverCacheStats solver_cache_stats() const;
+	//tests over the limits of the options in all the runs (summed over the workers),
+	//dropped tests are missing from the output
+	TestLimitStats test_limit_stats() const;
+	//stats of the conditions of all the runs (summed over the workers) in the source order,
+	//empty without ProgramOptions::collect_stats
+	std::vector<ConditionStats> condition_stats() const;
+	//where the time of building the program and of all the runs went
+	PhaseTimes phase_times() const;
+private:
+	//kept to build the same program for additional workers
+	std::string source;
+	ProgramOptions options;
+	//every worker has its own symbols, allocations, random engine and z3 context
+	//and runs the code compiled by this program with its own slot table
+	std::vector<std::unique_ptr<CompiledProgram>> workers;
+	CompiledProgram(const std::string &source, ProgramOptions options, CompiledProgram *owner);
+	//parses the source and generates the ir (filling the slot table)
+	void build_ir();
+	//optimizes and compiles the ir, sets d_gen_func
+	void compile();
+
+	//owns func and the rest of the nodes
+	std::unique_ptr<ASTArena> ast_arena;
+	FunctionNode *func = nullptr;
+	std::vector<std::shared_ptr<Symbol>> inputs;
+	std::unique_ptr<Runtime> runtime;
+	std::unique_ptr<CodegenVisitor> visitor;
+	std::unique_ptr<ObjectCache> object_cache;
+	std::unique_ptr<DGenJIT> jit;
+	//program whose compiled code is run (this for the main program)
+	CompiledProgram *owner = this;
+	//takes the slot table of the codegen visitor,
+	//null until the code is compiled (tests are interpreted meanwhile)
+	std::atomic<void (*)(void **slots)> d_gen_func{nullptr};
+	//compiles in the background with ExecMode::TIERED
+	std::thread compiler;
+	//error of the background compile, set before compile_failed
+	std::exception_ptr compile_error;
+	std::atomic<bool> compile_failed{false};
+	std::unique_ptr<Interpreter> interpreter;
+	std::unique_ptr<Serializer> serializer;
+	std::unique_ptr<ValuePlan> result_plan;
+
+	//where gather_res puts the cells (inputs and the result) of the currently generated test
+	std::vector<std::string> *cur_test = nullptr;
+	void gather_res(void *res);
+	TestLimitStats limit_stats;
+	//build stages and write_block, the rest is added by phase_times()
+	PhaseTimes times;
+	//written by compile(), which runs in the background with ExecMode::TIERED
+	std::atomic<uint64_t> compile_optimize_ns{0};
+	std::atomic<uint64_t> compile_jit_ns{0};
+	uint64_t run_ns = 0;
+	uint64_t gather_ns = 0;
+
+	//dropped tests are left without cells.
+	//edges (with coverage_guided only) get the branch edges hit by every test
+	void generate_block(int block, int tests_num, int seed, std::vector<std::vector<std::string>> &tests,
+						std::vector<std::vector<uint32_t>> *edges = nullptr);
+	//runs the compiled code or the interpreter for the current test
+	void run_test();
+	void prepare_workers(int num);
+
+	void reset();
+	friend void ::gather_res(CodegenVisitor *visitor, void *res);
+};
+
+#endif //D_GEN_COMPILEDPROGRAM_H
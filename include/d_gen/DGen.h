@@ -10,31 +10,31 @@
 #include <optional>
 #include <istream>
 
-class CodegenVisitor;
-class FunctionNode;
-class Symbol;
-
-extern "C" void gather_res(CodegenVisitor *visitor, void *res);
+#include "CompiledProgram.h"
 
 class DGen {
 public:
-	explicit DGen(std::istream &input);
+	explicit DGen(std::istream &input, ProgramOptions options = ProgramOptions());
 	~DGen() = default;
 
 	//TODO: add args: seed, number of tests, coverage
-	std::string generate_json(int tests_num, std::optional<int> seed = std::optional<int>());
+	std::string generate_json(int tests_num, std::optional<int> seed = std::optional<int>(), int threads = 1);
+	//writes the tests in ProgramOptions::format while they are generated
+	void generate_json(int tests_num, std::optional<int> seed, Sink &sink, int threads = 1);
+
+	//compiles the program on the first call, subsequent calls reuse it
+	CompiledProgram &compile();
+	//the same, the number of tests to generate picks the level of OptLevel::AUTO
+	CompiledProgram &compile(int tests_num);
+	//see CompiledProgram::condition_stats, empty before the program is compiled
+	std::vector<ConditionStats> condition_stats() const;
 
 	//only gets called once
 	static void init_backend();
 private:
 	std::istream &input;
-	std::vector<std::string> tests;
-	void gather_res(void *res);
-	FunctionNode *func;
-	std::vector<std::shared_ptr<Symbol>> inputs;
-
-	void reset();
-	friend void ::gather_res(CodegenVisitor *visitor, void *res);
+	ProgramOptions options;
+	std::unique_ptr<CompiledProgram> program;
 };
 
 #endif //D_GEN_DGEN_H
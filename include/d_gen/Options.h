@@ -0,0 +1,92 @@
+//
+// Created by Anton on 17.10.2026.
+//
+
+#ifndef D_GEN_OPTIONS_H
+#define D_GEN_OPTIONS_H
+
+#include <cstdint>
+#include <string>
+
+//how the conditions are encoded for z3
+enum class Z3Encoding {
+	//mathematical integers
+	INT,
+	//32 bit ints and 8 bit chars with wraparound, the same as in the generated code
+	BIT_VECTOR
+};
+
+//how the generated tests are written
+enum class OutputFormat {
+	JSON,
+	//length prefixed tests of native values
+	BINARY,
+	//row groups of native values, a column per input and the result
+	COLUMNAR
+};
+
+//llvm optimization level of the generated code
+enum class OptLevel {
+	//fastest compilation, for a few tests
+	O0,
+	O1,
+	O2,
+	//loop passes and vectorization are aggressive, for large batches
+	O3,
+	//picked by the number of tests (DGen), O2 when it isn't known
+	AUTO
+};
+
+//level for the given number of tests when the level is AUTO
+OptLevel resolve_opt_level(OptLevel level, int tests_num);
+
+//how the program is run for every test
+enum class ExecMode {
+	//compiled before the first test
+	JIT,
+	//tree walking interpreter, nothing is compiled
+	INTERPRETER,
+	//interpreted until the code compiled in the background is ready,
+	//a failed compile is thrown by the next generate (the tests are interpreted after that)
+	TIERED
+};
+
+//options of the program compilation
+struct ProgramOptions {
+	Z3Encoding encoding = Z3Encoding::INT;
+	OutputFormat format = OutputFormat::JSON;
+	OptLevel opt_level = OptLevel::AUTO;
+	ExecMode exec_mode = ExecMode::JIT;
+	//back-edges of the loops a test can take, 0 - no limit
+	uint64_t loop_budget = 0;
+	//time a test can run in milliseconds, 0 - no limit.
+	//unlike the budget it depends on the machine, so the output does too
+	int test_timeout_ms = 0;
+	//a test that ran over a limit is generated again from another random stream
+	//this many times, then it's dropped from the output
+	int abort_retries = 0;
+	//indexes of the local arrays are checked against their len, a test out of the bounds is aborted
+	//(as the ones over the limits) instead of corrupting the memory.
+	//indexes of the input arrays and the length of a created array are always checked
+	bool bounds_checks = false;
+	//edges of the ifs and loops are counted and every condition (with a precondition or not)
+	//is solved for its less visited edge, unless prob is given.
+	//the counters start from zero in every block of tests, so the output doesn't depend on the threads
+	bool coverage_guided = false;
+	//with coverage_guided the generation stops after the test that covers the last not covered edge
+	//(all the tests are generated if some edges are unreachable)
+	bool stop_when_covered = false;
+	//the conditions are counted and their solving is timed, see CompiledProgram::condition_stats
+	bool collect_stats = false;
+	//every test is timed for CompiledProgram::phase_times (the build is timed anyway)
+	bool collect_phase_times = false;
+
+	//the loops of the generated code are instrumented only when a limit is set
+	bool has_test_limits() const {
+		return loop_budget != 0 || test_timeout_ms > 0;
+	}
+	//directory of the compiled objects cache, no cache if empty
+	std::string object_cache_dir;
+};
+
+#endif //D_GEN_OPTIONS_H
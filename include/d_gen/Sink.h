@@ -0,0 +1,52 @@
+//
+// Created by Anton on 17.10.2026.
+//
+
+#ifndef D_GEN_SINK_H
+#define D_GEN_SINK_H
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+//destination of the generated tests, they are written as soon as they are ready
+class Sink {
+public:
+	virtual ~Sink() = default;
+	virtual void write(const char *data, size_t size) = 0;
+	virtual void flush() {}
+
+	void write(const std::string &data) {
+		write(data.data(), data.size());
+	}
+};
+
+//writes to the stream, buffering is left to the stream
+class OStreamSink: public Sink {
+public:
+	explicit OStreamSink(std::ostream &out);
+	void write(const char *data, size_t size) override;
+	void flush() override;
+	using Sink::write;
+private:
+	std::ostream &out;
+};
+
+//writes to the file descriptor through its own buffer,
+//the descriptor isn't closed
+class FdSink: public Sink {
+public:
+	explicit FdSink(int fd, size_t buf_size = 1 << 16);
+	~FdSink() override;
+	void write(const char *data, size_t size) override;
+	void flush() override;
+	using Sink::write;
+private:
+	int fd;
+	std::vector<char> buf;
+	size_t used = 0;
+	void write_all(const char *data, size_t size);
+};
+
+#endif //D_GEN_SINK_H
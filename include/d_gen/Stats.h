@@ -0,0 +1,117 @@
+//
+// Created by Anton on 17.10.2026.
+//
+
+#ifndef D_GEN_STATS_H
+#define D_GEN_STATS_H
+
+#include <cstdint>
+
+//queries answered from the solutions cache (hits)
+//and the ones that were passed to z3 (misses)
+struct SolverCacheStats {
+	uint64_t hits = 0;
+	uint64_t misses = 0;
+
+	SolverCacheStats &operator+=(const SolverCacheStats &other) {
+		hits += other.hits;
+		misses += other.misses;
+		return *this;
+	}
+};
+
+//tests that were aborted (over the limits of ProgramOptions or out of the bounds of an array):
+//generated again from another random stream (retries) or left out of the output (dropped)
+struct TestLimitStats {
+	uint64_t retries = 0;
+	uint64_t dropped = 0;
+	//aborts by the reason, the retried ones included
+	uint64_t over_budget = 0;
+	uint64_t timed_out = 0;
+	uint64_t out_of_bounds = 0;
+
+	TestLimitStats &operator+=(const TestLimitStats &other) {
+		retries += other.retries;
+		dropped += other.dropped;
+		over_budget += other.over_budget;
+		timed_out += other.timed_out;
+		out_of_bounds += other.out_of_bounds;
+		return *this;
+	}
+};
+
+//what happened at a condition of an if or a loop in all the runs (ProgramOptions::collect_stats)
+struct ConditionStats {
+	//position of the precondition, or of the if/loop if it has none
+	int line = 0;
+	int col = 0;
+	bool has_precond = false;
+
+	//evaluations of the condition by its value
+	uint64_t true_count = 0;
+	uint64_t false_count = 0;
+
+	//solving of the condition (with a precondition or coverage_guided):
+	//the condition is negated to follow prob or the coverage
+	uint64_t negated = 0;
+	//every input of the condition already has a value
+	uint64_t skipped = 0;
+	uint64_t cache_hits = 0;
+	//queries passed to z3 and their results other than sat
+	uint64_t solver_calls = 0;
+	uint64_t unsat = 0;
+	uint64_t unknown = 0;
+	uint64_t solver_time_ns = 0;
+
+	uint64_t executions() const {
+		return true_count + false_count;
+	}
+
+	ConditionStats &operator+=(const ConditionStats &other) {
+		true_count += other.true_count;
+		false_count += other.false_count;
+		negated += other.negated;
+		skipped += other.skipped;
+		cache_hits += other.cache_hits;
+		solver_calls += other.solver_calls;
+		unsat += other.unsat;
+		unknown += other.unknown;
+		solver_time_ns += other.solver_time_ns;
+		return *this;
+	}
+};
+
+//wall time of the stages of the pipeline in nanoseconds, summed over the workers
+//(they are built and generate in parallel, so with threads it's the cpu time)
+struct PhaseTimes {
+	//building the program
+	uint64_t parse_ns = 0;
+	uint64_t semantics_ns = 0;
+	uint64_t codegen_ns = 0;
+	//llvm passes, skipped on a hit of the compiled programs cache
+	uint64_t optimize_ns = 0;
+	//machine code generation (or loading the cached object) and linking
+	uint64_t jit_ns = 0;
+
+	//generation, with ProgramOptions::collect_phase_times only (but the blocks of serialize_ns):
+	//running the tests without the solving and the serialization they call
+	uint64_t execute_ns = 0;
+	//z3_gen calls: z3 expressions of the condition, the solutions cache and the solver
+	uint64_t solve_ns = 0;
+	//cells of the tests and assembling the blocks
+	uint64_t serialize_ns = 0;
+
+	PhaseTimes &operator+=(const PhaseTimes &other) {
+		parse_ns += other.parse_ns;
+		semantics_ns += other.semantics_ns;
+		codegen_ns += other.codegen_ns;
+		optimize_ns += other.optimize_ns;
+		jit_ns += other.jit_ns;
+		execute_ns += other.execute_ns;
+		solve_ns += other.solve_ns;
+		serialize_ns += other.serialize_ns;
+		return *this;
+	}
+};
+
+#endif //D_GEN_STATS_H
@@ -0,0 +1,53 @@
+//
+// Created by Anton on 17.10.2026.
+//
+
+#include "ASTArena.h"
+
+#include <algorithm>
+
+#include "ast.h"
+
+thread_local ASTArena *ASTArena::cur_arena = nullptr;
+
+ASTArena::ASTArena(size_t chunk_size): chunk_size(chunk_size) {}
+
+ASTArena::~ASTArena() {
+	//a node doesn't touch its children in the destructor
+	for (auto it = nodes.rbegin(); it != nodes.rend(); ++it) {
+		(*it)->~ASTNode();
+	}
+}
+
+ASTArena::Scope::Scope(ASTArena &arena): prev(cur_arena) {
+	cur_arena = &arena;
+}
+
+ASTArena::Scope::~Scope() {
+	cur_arena = prev;
+}
+
+ASTArena *ASTArena::current() {
+	return cur_arena;
+}
+
+void *ASTArena::alloc_node(size_t size) {
+	size = (size + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+	if ((size_t)(end - cur) < size) {
+		auto new_size = std::max(chunk_size, size);
+		chunks.push_back(std::make_unique<uint8_t[]>(new_size));
+		cur = chunks.back().get();
+		end = cur + new_size;
+	}
+	auto mem = cur;
+	cur += size;
+	nodes.push_back(reinterpret_cast<ASTNode*>(mem));
+	return mem;
+}
+
+void ASTArena::forget_node(void *ptr) {
+	auto it = std::find(nodes.rbegin(), nodes.rend(), reinterpret_cast<ASTNode*>(ptr));
+	if (it != nodes.rend()) {
+		nodes.erase(std::next(it).base());
+	}
+}
@@ -0,0 +1,52 @@
+//
+// Created by Anton on 17.10.2026.
+//
+
+#ifndef D_GEN_ASTARENA_H
+#define D_GEN_ASTARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class ASTNode;
+
+//owns all the nodes of a program: they are allocated from its chunks
+//while it's the current arena of the thread (see Scope) and are destroyed together with it,
+//so the nodes of a body lie next to each other and there are no deletes of the single nodes
+class ASTArena {
+public:
+	explicit ASTArena(size_t chunk_size = 64 * 1024);
+	//destroys the nodes in the reverse order and releases the chunks
+	~ASTArena();
+
+	ASTArena(const ASTArena&) = delete;
+	ASTArena &operator=(const ASTArena&) = delete;
+
+	//makes the arena current for the nodes created by this thread in the scope
+	class Scope {
+	public:
+		explicit Scope(ASTArena &arena);
+		~Scope();
+	private:
+		ASTArena *prev;
+	};
+
+	static ASTArena *current();
+
+	void *alloc_node(size_t size);
+	//the node's constructor has thrown, it must not be destroyed
+	void forget_node(void *ptr);
+private:
+	size_t chunk_size;
+	std::vector<std::unique_ptr<uint8_t[]>> chunks;
+	uint8_t *cur = nullptr;
+	uint8_t *end = nullptr;
+	//in the order of the allocation
+	std::vector<ASTNode*> nodes;
+
+	static thread_local ASTArena *cur_arena;
+};
+
+#endif //D_GEN_ASTARENA_H
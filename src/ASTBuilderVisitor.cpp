@@ -6,7 +6,11 @@
 #include "utils/assert.h"
 #include "BuildError.h"
 
+//a chain of one operand (the most of the expressions on every level) is passed as is
 #define gen_bin_op_construction(func) \
+	if (ctx->operands.size() == 1) { \
+		return func(ctx->operands[0]); \
+	} \
 	auto lhs = std::any_cast<ASTNode*>(func(ctx->operands[0])); \
 	for (int i = 1; i < ctx->operands.size(); i++) { \
 		auto pos = getStartPos(ctx->operands[i]); \
@@ -37,11 +41,28 @@ FunctionNode *ASTBuilderVisitor::parse() {
 	lexer.addErrorListener(err_listener.get());
 	antlr4::CommonTokenStream tokens(&lexer);
 
+	//the atn and the dfa cache are static members of the generated parser and lexer,
+	//so they stay warm for the next parses of the process (workers and later programs)
 	d_genParser parser(&tokens);
 	parser.removeErrorListeners();
-	parser.addErrorListener(err_listener.get());
 
-	d_genParser::ProgramContext* program = parser.program();
+	//sll prediction is enough for almost every program and is much cheaper,
+	//it is bailed out on the first error and the program is parsed again with full ll,
+	//so the syntax errors are reported by ll only and are the same as before
+	d_genParser::ProgramContext* program;
+	auto simulator = parser.getInterpreter<antlr4::atn::ParserATNSimulator>();
+	simulator->setPredictionMode(antlr4::atn::PredictionMode::SLL);
+	parser.setErrorHandler(std::make_shared<antlr4::BailErrorStrategy>());
+	try {
+		program = parser.program();
+	} catch (const antlr4::ParseCancellationException &) {
+		//rewinds the token stream as well, the tokens aren't lexed again
+		parser.reset();
+		simulator->setPredictionMode(antlr4::atn::PredictionMode::LL);
+		parser.setErrorHandler(std::make_shared<antlr4::DefaultErrorStrategy>());
+		parser.addErrorListener(err_listener.get());
+		program = parser.program();
+	}
 
 //	std::cout << tokens.size() << std::endl;
 //	for (auto tok: tokens.getTokens()) {
@@ -0,0 +1,37 @@
+//
+// Created by Anton on 17.10.2026.
+//
+
+#include "Arena.h"
+
+#include <algorithm>
+
+Arena::Arena(size_t chunk_size): chunk_size(chunk_size) {}
+
+void Arena::reset() {
+	cur_chunk = 0;
+	if (chunks.empty()) {
+		cur = end = nullptr;
+		return;
+	}
+	cur = chunks[0].data.get();
+	end = cur + chunks[0].size;
+}
+
+uint8_t *Arena::alloc_slow(size_t size) {
+	//move to the next chunk that can hold the allocation
+	size_t next = chunks.empty() ? 0 : cur_chunk + 1;
+	while (next < chunks.size() && chunks[next].size < size) {
+		next++;
+	}
+
+	if (next == chunks.size()) {
+		auto new_size = std::max(chunk_size, size);
+		chunks.push_back({std::make_unique<uint8_t[]>(new_size), new_size});
+	}
+
+	cur_chunk = next;
+	cur = chunks[next].data.get();
+	end = cur + chunks[next].size;
+	return cur;
+}
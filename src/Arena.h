@@ -0,0 +1,71 @@
+//
+// Created by Anton on 17.10.2026.
+//
+
+#ifndef D_GEN_ARENA_H
+#define D_GEN_ARENA_H
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+//header in front of the data of every runtime array and string
+struct ArrHeader {
+	uint32_t len;
+	//keeps the data 8 byte aligned
+	uint32_t pad;
+};
+
+//bump allocator for the values of a single test
+//everything is released at once by reset()
+class Arena {
+public:
+	explicit Arena(size_t chunk_size = 64 * 1024);
+
+	//returns pointer to the data, length is stored in the header before it
+	uint8_t *alloc_arr(uint32_t len, uint32_t elem_size) {
+		size_t size = align(sizeof(ArrHeader) + (size_t)len * elem_size);
+		uint8_t *mem = cur;
+		if ((size_t)(end - cur) < size) {
+			mem = alloc_slow(size);
+		}
+		cur = mem + size;
+
+		auto header = reinterpret_cast<ArrHeader*>(mem);
+		header->len = len;
+		header->pad = 0;
+		return mem + sizeof(ArrHeader);
+	}
+
+	//data of the shared empty array, the elements of created arrays of arrays point to it
+	static uint8_t *empty_arr() {
+		static ArrHeader header{0, 0};
+		return reinterpret_cast<uint8_t*>(&header + 1);
+	}
+
+	static uint32_t get_len(const uint8_t *data) {
+		return reinterpret_cast<const ArrHeader*>(data - sizeof(ArrHeader))->len;
+	}
+
+	//chunks are kept for the next test
+	void reset();
+private:
+	struct Chunk {
+		std::unique_ptr<uint8_t[]> data;
+		size_t size;
+	};
+
+	size_t chunk_size;
+	std::vector<Chunk> chunks;
+	size_t cur_chunk = 0;
+	uint8_t *cur = nullptr;
+	uint8_t *end = nullptr;
+
+	uint8_t *alloc_slow(size_t size);
+	static size_t align(size_t size) {
+		return (size + 7) & ~(size_t)7;
+	}
+};
+
+#endif //D_GEN_ARENA_H
@@ -2,40 +2,46 @@
 // Created by Anton on 27.05.2023.
 //
 
-#include "llvm/IR/LegacyPassManager.h"
-#include "llvm/Transforms/InstCombine/InstCombine.h"
-#include "llvm/Transforms/Scalar.h"
-#include "llvm/Transforms/Scalar/GVN.h"
-#include "llvm/Transforms/Utils.h"
+#include <algorithm>
+#include <cstring>
+
+#include "llvm/Config/llvm-config.h"
+#include "llvm/IR/MDBuilder.h"
+#include "llvm/Passes/PassBuilder.h"
+#include "llvm/Target/TargetMachine.h"
 
 #include "utils/assert.h"
 
 #include "CodegenVisitor.h"
 
-#include "DGen.h"
+#include "CompiledProgram.h"
 
 
-CodegenVisitor::CodegenVisitor(DGen *d_gen): d_gen(d_gen) {
+CodegenVisitor::CodegenVisitor(CompiledProgram *program, Runtime *rt, const ProgramOptions &options):
+	program(program), rt(rt), limit_loops(options.has_test_limits()),
+	bounds_checks(options.bounds_checks), coverage_guided(options.coverage_guided),
+	count_branches(options.coverage_guided || options.collect_stats) {
 	ctx = std::make_unique<llvm::LLVMContext>();
 	mod = std::make_unique<llvm::Module>("test", *ctx);
 
+	//void d_gen_func(void **slots)
 	llvm::Function *d_gen_func =
 			llvm::Function::Create(llvm::FunctionType::get(llvm::Type::getVoidTy(*ctx),
-														   {}, false),
+														   {llvm::Type::getInt8PtrTy(*ctx)->getPointerTo()}, false),
 								   llvm::Function::ExternalLinkage, D_GEN_FUNC_NAME, mod.get());
 
 	llvm::BasicBlock *BB = llvm::BasicBlock::Create(*ctx, "EntryBlock", d_gen_func);
 	builder = std::make_unique<llvm::IRBuilder<>>(BB);
 
 	z3_visitor = std::make_unique<CodegenZ3Visitor>(ctx.get(), mod.get(),
-													builder.get(), this);
+													builder.get(), this, rt, options.encoding,
+													options.coverage_guided, options.collect_phase_times);
 }
 
 
 llvm::Value *CodegenVisitor::code_gen(FunctionNode *func) {
 	this->func = func;
 	code_gen(func->body);
-	run_optimizations();
 	return nullptr;
 }
 
@@ -55,21 +61,28 @@ llvm::Value *CodegenVisitor::code_gen(NumberNode *node) {
 	return builder->getInt32(node->num);
 }
 
-extern "C" void set_global_ptr_size(char *str) {
-	Symbol::allocated_vals[(uint8_t*)str] = {false, (uint32_t)strlen(str)};
+llvm::Constant *CodegenVisitor::create_const_arr(llvm::Constant *data, uint32_t len) {
+	//same layout as the arena allocations: header with len followed by the data
+	auto header_t = llvm::StructType::get(*ctx, {builder->getInt32Ty(), builder->getInt32Ty()});
+	auto header = llvm::ConstantStruct::get(header_t, {builder->getInt32(len), builder->getInt32(0)});
+	auto init = llvm::ConstantStruct::getAnon(*ctx, {header, data});
+
+	auto global = new llvm::GlobalVariable(*mod, init->getType(), true,
+										   llvm::GlobalValue::PrivateLinkage, init, "const_arr");
+	global->setUnnamedAddr(llvm::GlobalValue::UnnamedAddr::Global);
+	global->setAlignment(llvm::Align(sizeof(ArrHeader)));
+
+	auto zero = builder->getInt32(0);
+	auto one = builder->getInt32(1);
+	auto data_ptr = llvm::ConstantExpr::getInBoundsGetElementPtr(init->getType(), global,
+																  llvm::ArrayRef<llvm::Constant*>{zero, one, zero});
+	return llvm::ConstantExpr::getBitCast(data_ptr, builder->getInt8PtrTy());
 }
 
 llvm::Value *CodegenVisitor::code_gen(StringNode *node) {
-	auto addr = builder->CreateGlobalStringPtr(node->str);
-
-	auto set_global_ptr_size_t = llvm::FunctionType::get(llvm::Type::getVoidTy(*ctx),
-												{llvm::Type::getInt8PtrTy(*ctx)}, false);
-
-	auto set_global_ptr_size_cb = mod->getOrInsertFunction("set_global_ptr_size", set_global_ptr_size_t);
-
-	builder->CreateCall(set_global_ptr_size_cb, {addr});
-
-	return addr;
+	//null terminated for the callbacks, len doesn't count the terminator
+	auto data = llvm::ConstantDataArray::getString(*ctx, node->str, true);
+	return create_const_arr(data, node->str.size());
 }
 
 llvm::Value *CodegenVisitor::code_gen(CharNode *node) {
@@ -120,6 +133,12 @@ llvm::Value *CodegenVisitor::code_gen(IdentNode *node) {
 llvm::Value *CodegenVisitor::code_gen(DefNode *node) {
 	node->sym->create_alloca(get_ctx());
 	if (!node->rhs) {
+		if (node->type.getCurrentType() == TypeKind::ARR || node->type.getCurrentType() == TypeKind::STRING) {
+			//not initialized arrays are empty
+			auto empty = create_const_arr(llvm::ConstantDataArray::get(*ctx, llvm::ArrayRef<uint8_t>()), 0);
+			auto alloca_t = node->sym->alloca->getAllocatedType();
+			builder->CreateStore(llvm::ConstantExpr::getBitCast(empty, alloca_t), node->sym->alloca);
+		}
 		return nullptr;
 	}
 
@@ -132,11 +151,11 @@ llvm::Value *CodegenVisitor::code_gen(DefNode *node) {
 }
 
 LLVMCtx CodegenVisitor::get_ctx() {
-	return {ctx.get(), mod.get(), builder.get()};
+	return {ctx.get(), mod.get(), builder.get(), rt, &slots, &llvm_types};
 }
 
 extern "C" void gather_res(CodegenVisitor *visitor, void *res) {
-	visitor->d_gen->gather_res(res);
+	visitor->program->gather_res(res);
 }
 
 llvm::Value *CodegenVisitor::code_gen(ReturnNode *node) {
@@ -158,6 +177,22 @@ llvm::orc::ThreadSafeModule CodegenVisitor::get_module() {
 	return {std::move(mod), std::move(ctx)};
 }
 
+void CodegenVisitor::reset_z3_ctx() {
+	z3_visitor->reset();
+}
+
+SolverCacheStats CodegenVisitor::get_solver_cache_stats() const {
+	return z3_visitor->get_cache_stats();
+}
+
+uint64_t CodegenVisitor::get_solve_time_ns() const {
+	return z3_visitor->get_solve_time_ns();
+}
+
+CodegenZ3Visitor *CodegenVisitor::get_z3_visitor() {
+	return z3_visitor.get();
+}
+
 llvm::Value *CodegenVisitor::code_gen(AsgNode *node) {
 	auto addr = get_address(node->lhs);
 	auto rhs = node->rhs->code_gen(this);
@@ -166,16 +201,19 @@ llvm::Value *CodegenVisitor::code_gen(AsgNode *node) {
 }
 
 llvm::Value *CodegenVisitor::get_address(ASTNode *node) {
-	if (auto ident = dynamic_cast<IdentNode*>(node)) {
+	if (auto ident = node_cast<IdentNode>(node)) {
 		return ident->symbol->alloca;
-	} else if (auto lookup = dynamic_cast<ArrLookupNode*>(node)) {
+	} else if (auto lookup = node_cast<ArrLookupNode>(node)) {
 		auto sym = lookup->ident->symbol;
 		llvm::Value *addr = sym->alloca;
 
 		for (auto &idx: lookup->idxs) {
 			auto ptr = builder->CreateLoad(addr->getType()->getPointerElementType(), addr);
-			addr = builder->CreateGEP(ptr->getType()->getPointerElementType(),
-									  ptr, idx->code_gen(this));
+			auto idx_val = idx->code_gen(this);
+			if (bounds_checks) {
+				code_gen_bounds_check(lookup, ptr, idx_val);
+			}
+			addr = builder->CreateGEP(ptr->getType()->getPointerElementType(), ptr, idx_val);
 		}
 
 		return addr;
@@ -184,6 +222,35 @@ llvm::Value *CodegenVisitor::get_address(ASTNode *node) {
 	ASSERT(false, "expected ident or array lookup node on the left side");
 }
 
+extern "C" void out_of_bounds(ArrLookupNode *node, int32_t idx, uint32_t len) {
+	throw TestAborted(TestAborted::OUT_OF_BOUNDS, "index " + std::to_string(idx) + " is out of the bounds of \"" +
+					  node->ident->name + "\" of len " + std::to_string(len) + " at " +
+					  std::to_string(node->pos.line) + ":" + std::to_string(node->pos.col));
+}
+
+void CodegenVisitor::code_gen_bounds_check(ArrLookupNode *node, llvm::Value *data_ptr, llvm::Value *idx) {
+	//len is an invariant load, so it's hoisted out of the loops with the array
+	auto len = load_arr_len(data_ptr);
+
+	auto main = mod->getFunction(D_GEN_FUNC_NAME);
+	auto fail_bb = llvm::BasicBlock::Create(*ctx, "out_of_bounds_bb", main);
+	auto cont_bb = llvm::BasicBlock::Create(*ctx, "in_bounds_bb", main);
+	//negative indexes are huge unsigned ones
+	auto weights = llvm::MDBuilder(*ctx).createBranchWeights(1 << 20, 1);
+	builder->CreateCondBr(builder->CreateICmpULT(idx, len), cont_bb, fail_bb, weights);
+
+	builder->SetInsertPoint(fail_bb);
+	auto out_of_bounds_t = llvm::FunctionType::get(llvm::Type::getVoidTy(*ctx),
+												   {llvm::Type::getInt8PtrTy(*ctx),
+													llvm::Type::getInt32Ty(*ctx),
+													llvm::Type::getInt32Ty(*ctx)}, false);
+	auto out_of_bounds_cb = mod->getOrInsertFunction("out_of_bounds", out_of_bounds_t);
+	builder->CreateCall(out_of_bounds_cb, {Symbol::get_ptr(node, get_ctx()), idx, len});
+	builder->CreateUnreachable();
+
+	builder->SetInsertPoint(cont_bb);
+}
+
 llvm::Value *CodegenVisitor::code_gen(ArrLookupNode *node) {
 	auto symbol = node->ident->symbol;
 
@@ -201,58 +268,118 @@ llvm::Value *CodegenVisitor::code_gen(ArrLookupNode *node) {
 	return arr_sym->code_gen_idx(idxs, get_ctx());
 }
 
-extern "C" uint32_t get_property(PropertyLookupNode *node, uint8_t *data) {
-	auto sym = node->ident->symbol;
-	if (sym->is_input) {
-		auto arr = std::dynamic_pointer_cast<ArraySym>(sym);
-		return arr->get_size();
-	}
-	return Symbol::allocated_vals[data].size;
+extern "C" uint32_t get_property(PropertyLookupNode *node, Runtime *rt) {
+	auto arr = std::dynamic_pointer_cast<ArraySym>(node->ident->symbol);
+	auto size = arr->get_size(*rt->rng);
+	arr->materialize(*rt);
+	return size;
+}
+
+llvm::Value *CodegenVisitor::load_arr_len(llvm::Value *data_ptr) {
+	//len is in the header right before the data
+	auto len_ptr = builder->CreateBitCast(data_ptr, builder->getInt32Ty()->getPointerTo());
+	len_ptr = builder->CreateConstInBoundsGEP1_64(builder->getInt32Ty(), len_ptr,
+												  -(int64_t)(sizeof(ArrHeader) / sizeof(uint32_t)));
+	auto len = builder->CreateLoad(builder->getInt32Ty(), len_ptr, "len");
+	//header is written once on allocation, so the load can be hoisted out of loops
+	len->setMetadata(llvm::LLVMContext::MD_invariant_load, llvm::MDNode::get(*ctx, {}));
+	return len;
 }
 
 llvm::Value *CodegenVisitor::code_gen(PropertyLookupNode *node) {
 	auto sym = node->ident->symbol;
+	if (!sym->is_input) {
+		auto data_ptr = builder->CreateLoad(sym->alloca->getAllocatedType(), sym->alloca);
+		return load_arr_len(data_ptr);
+	}
+
+	//size of the input array may be not generated yet
 	auto property_cb_t = llvm::FunctionType::get(llvm::Type::getInt32Ty(*ctx),
 											{llvm::Type::getInt8PtrTy(*ctx),
-											 Symbol::map_type_to_llvm_type(sym->type, get_ctx())}, false);
+											 llvm::Type::getInt8PtrTy(*ctx)}, false);
 
 	auto property_cb = mod->getOrInsertFunction("get_property", property_cb_t);
 
-	llvm::Value *data_ptr = Symbol::get_ptr(nullptr, get_ctx());
-	if (!sym->is_input) {
-		data_ptr = builder->CreateLoad(sym->alloca->getAllocatedType(), sym->alloca);
+	auto arr = std::dynamic_pointer_cast<ArraySym>(sym);
+	if (!arr->is_native()) {
+		return builder->CreateCall(property_cb, {Symbol::get_ptr(node, get_ctx()),
+												 Symbol::get_ptr(rt, get_ctx())});
 	}
 
-	return builder->CreateCall(property_cb, {Symbol::get_ptr(node, get_ctx()), data_ptr});
+	//len of the materialized array is kept in the native buffer
+	auto main = mod->getFunction(D_GEN_FUNC_NAME);
+	auto cb_bb = llvm::BasicBlock::Create(*ctx, "len_cb_bb", main);
+	auto merge_bb = llvm::BasicBlock::Create(*ctx, "len_merge_bb", main);
+	auto entry_bb = builder->GetInsertBlock();
+	auto native_len = arr->load_native(NativeArr::LEN, get_ctx());
+	auto data = arr->load_native(NativeArr::DATA, get_ctx());
+	builder->CreateCondBr(builder->CreateIsNull(data), cb_bb, merge_bb);
+
+	builder->SetInsertPoint(cb_bb);
+	auto cb_len = builder->CreateCall(property_cb, {Symbol::get_ptr(node, get_ctx()),
+													Symbol::get_ptr(rt, get_ctx())});
+	builder->CreateBr(merge_bb);
+
+	builder->SetInsertPoint(merge_bb);
+	auto len = builder->CreatePHI(builder->getInt32Ty(), 2, "len");
+	len->addIncoming(native_len, entry_bb);
+	len->addIncoming(cb_len, cb_bb);
+	return len;
 }
 
-extern "C" uint8_t *create_arr(int32_t len, uint32_t pointed_sizeof) {
+extern "C" uint8_t *create_arr(int32_t len, uint32_t pointed_sizeof, Runtime *rt) {
+	//the test is aborted as an out of bounds index, the run goes on
 	if (len < 0) {
-		throw std::runtime_error("create array with len < 0: " + std::to_string(len));
+		throw TestAborted(TestAborted::OUT_OF_BOUNDS, "create array with len < 0: " + std::to_string(len));
 	}
-	
-	auto *data = static_cast<uint8_t *>(malloc(len * pointed_sizeof));
-	Symbol::allocated_vals[data] = {true, (uint32_t)len};
+
+	//the arena memory is left by the previous tests of the worker,
+	//an element read before it's written must not depend on them
+	auto data = rt->arena.alloc_arr(len, pointed_sizeof);
+	std::memset(data, 0, (size_t)len * pointed_sizeof);
+	return data;
+}
+
+//elements of arrays of arrays and strings are empty, so their len and the bounds checks work
+extern "C" uint8_t *create_arr_of_arrs(int32_t len, Runtime *rt) {
+	auto data = create_arr(len, sizeof(uint8_t*), rt);
+	std::fill_n(reinterpret_cast<uint8_t**>(data), len, Arena::empty_arr());
 	return data;
 }
 
 llvm::Value *CodegenVisitor::code_gen(ArrCreateNode *node) {
-	auto pointed_sizeof = Symbol::create_symbol(Position(0, 0), node->type.dropType(), "tmp")->get_sizeof();
+	auto pointed_sizeof = node->type.dropType().get_sizeof();
 
 	auto create_arr_t = llvm::FunctionType::get(Symbol::map_type_to_llvm_type(node->type, get_ctx()),
 												 {llvm::Type::getInt32Ty(*ctx),
-												  llvm::Type::getInt32Ty(*ctx)}, false);
+												  llvm::Type::getInt32Ty(*ctx),
+												  llvm::Type::getInt8PtrTy(*ctx)}, false);
+
+	auto elem_kind = node->type.dropType().getCurrentType();
+	if (elem_kind == TypeKind::ARR || elem_kind == TypeKind::STRING) {
+		auto create_arr_of_arrs_t = llvm::FunctionType::get(Symbol::map_type_to_llvm_type(node->type, get_ctx()),
+															 {llvm::Type::getInt32Ty(*ctx),
+															  llvm::Type::getInt8PtrTy(*ctx)}, false);
+		auto create_arr_of_arrs_cb = mod->getOrInsertFunction("create_arr_of_arrs", create_arr_of_arrs_t);
+		return builder->CreateCall(create_arr_of_arrs_cb, {node->len->code_gen(this), Symbol::get_ptr(rt, get_ctx())},
+								   "created_arr_ptr");
+	}
 
 	auto create_arr_cb = mod->getOrInsertFunction("create_arr", create_arr_t);
 
-	return builder->CreateCall(create_arr_cb, {node->len->code_gen(this), builder->getInt32(pointed_sizeof)}, "created_arr_ptr");
+	return builder->CreateCall(create_arr_cb, {node->len->code_gen(this), builder->getInt32(pointed_sizeof),
+											   Symbol::get_ptr(rt, get_ctx())}, "created_arr_ptr");
 }
 
 llvm::Value *CodegenVisitor::code_gen(IfNode *node) {
-	if (node->precond) {
+	auto branch = count_branches ? add_branch(node->cond, node->pos, node->precond) : nullptr;
+	if (node->precond || coverage_guided) {
 		z3_visitor->prepare_eval_ctx(node->cond, node->precond);
 	}
 	auto cond_value = node->cond->code_gen(this);
+	if (branch) {
+		code_gen_branch_hit(branch, cond_value);
+	}
 	auto main = mod->getFunction(D_GEN_FUNC_NAME);
 	auto then_bb = llvm::BasicBlock::Create(*ctx, "then", main);
 	auto else_bb = llvm::BasicBlock::Create(*ctx, "else", main);
@@ -285,10 +412,10 @@ bool CodegenVisitor::is_last_stmt_br(BodyNode *node) {
 		return false;
 	}
 	auto stmt = *(--node->stmts.end());
-	if (dynamic_cast<ContinueNode*>(stmt) || dynamic_cast<BreakNode*>(stmt) ||
-		dynamic_cast<ReturnNode*>(stmt)) {
+	if (node_cast<ContinueNode>(stmt) || node_cast<BreakNode>(stmt) ||
+		node_cast<ReturnNode>(stmt)) {
 		return true;
-	} else if (auto if_node = dynamic_cast<IfNode*>(stmt)) {
+	} else if (auto if_node = node_cast<IfNode>(stmt)) {
 		auto then_has_br = is_last_stmt_br(if_node->body);
 		auto else_has_br = false;
 		if (if_node->else_body) {
@@ -318,10 +445,15 @@ llvm::Value *CodegenVisitor::code_gen(ForNode *node) {
 	builder->CreateBr(loop_cond_bb);
 
 	builder->SetInsertPoint(loop_cond_bb);
-	if (node->precond) {
+	auto branch = count_branches ? add_branch(node->cond, node->pos, node->precond) : nullptr;
+	if (node->precond || coverage_guided) {
 		z3_visitor->prepare_eval_ctx(node->cond, node->precond);
 	}
-	builder->CreateCondBr(node->cond->code_gen(this), loop_bb, merge_bb);
+	auto cond_value = node->cond->code_gen(this);
+	if (branch) {
+		code_gen_branch_hit(branch, cond_value);
+	}
+	builder->CreateCondBr(cond_value, loop_bb, merge_bb);
 
 	builder->SetInsertPoint(loop_bb);
 	code_gen(node->body);
@@ -329,7 +461,7 @@ llvm::Value *CodegenVisitor::code_gen(ForNode *node) {
 		if (node->inc_asg) {
 			code_gen(node->inc_asg);
 		}
-		builder->CreateBr(loop_cond_bb);
+		code_gen_back_edge(node);
 	}
 
 	builder->SetInsertPoint(merge_bb);
@@ -338,10 +470,55 @@ llvm::Value *CodegenVisitor::code_gen(ForNode *node) {
 }
 
 llvm::Value *CodegenVisitor::code_gen(ContinueNode *node) {
-	builder->CreateBr(node->loop->loop_cond_bb);
+	code_gen_back_edge(node->loop);
 	return nullptr;
 }
 
+Coverage::Branch *CodegenVisitor::add_branch(ASTNode *cond, Position pos, PrecondNode *precond) {
+	//the stats of a guarded condition are reported at its precondition
+	return rt->coverage.add_branch(cond, precond ? precond->pos : pos, precond != nullptr);
+}
+
+void CodegenVisitor::code_gen_branch_hit(Coverage::Branch *branch, llvm::Value *cond_value) {
+	//hits[cond]++
+	auto hits = builder->CreateBitCast(Symbol::get_ptr(branch->hits, get_ctx()),
+									   builder->getInt64Ty()->getPointerTo());
+	auto edge = builder->CreateZExt(builder->CreateIsNotNull(cond_value), builder->getInt64Ty());
+	auto hit_ptr = builder->CreateGEP(builder->getInt64Ty(), hits, edge);
+	auto hit = builder->CreateLoad(builder->getInt64Ty(), hit_ptr);
+	builder->CreateStore(builder->CreateAdd(hit, builder->getInt64(1)), hit_ptr);
+}
+
+extern "C" void loop_check(Runtime *rt) {
+	rt->limits.check();
+}
+
+void CodegenVisitor::code_gen_back_edge(ForNode *loop) {
+	if (limit_loops) {
+		auto steps_ptr = builder->CreateBitCast(Symbol::get_ptr(&rt->limits.steps_left, get_ctx()),
+												builder->getInt64Ty()->getPointerTo());
+		auto steps = builder->CreateSub(builder->CreateLoad(builder->getInt64Ty(), steps_ptr), builder->getInt64(1));
+		builder->CreateStore(steps, steps_ptr);
+
+		auto main = mod->getFunction(D_GEN_FUNC_NAME);
+		auto check_bb = llvm::BasicBlock::Create(*ctx, "loop_check_bb", main);
+		auto cont_bb = llvm::BasicBlock::Create(*ctx, "loop_cont_bb", main);
+		//the check is rare, the loop body stays on the hot path
+		auto weights = llvm::MDBuilder(*ctx).createBranchWeights(1, DEADLINE_CHECK_MIN_STEPS);
+		builder->CreateCondBr(builder->CreateICmpSLT(steps, builder->getInt64(0)), check_bb, cont_bb, weights);
+
+		builder->SetInsertPoint(check_bb);
+		auto loop_check_t = llvm::FunctionType::get(llvm::Type::getVoidTy(*ctx),
+													{llvm::Type::getInt8PtrTy(*ctx)}, false);
+		auto loop_check_cb = mod->getOrInsertFunction("loop_check", loop_check_t);
+		builder->CreateCall(loop_check_cb, {Symbol::get_ptr(rt, get_ctx())});
+		builder->CreateBr(cont_bb);
+
+		builder->SetInsertPoint(cont_bb);
+	}
+	builder->CreateBr(loop->loop_cond_bb);
+}
+
 llvm::Value *CodegenVisitor::code_gen(BreakNode *node) {
 	builder->CreateBr(node->loop->merge_bb);
 	return nullptr;
@@ -354,23 +531,43 @@ llvm::Value *CodegenVisitor::convert_val_if_convertible(llvm::Value *val, Type s
 	return val;
 }
 
-void CodegenVisitor::run_optimizations() {
-	llvm::Function *d_gen_func = mod->getFunction(D_GEN_FUNC_NAME);
-	auto functionPassManager =
-			std::make_unique<llvm::legacy::FunctionPassManager>(mod.get());
-
-	// Promote allocas to registers.
-	functionPassManager->add(llvm::createPromoteMemoryToRegisterPass());
-	// Do simple "peephole" optimizations
-	functionPassManager->add(llvm::createInstructionCombiningPass());
-	// Reassociate expressions.
-	functionPassManager->add(llvm::createReassociatePass());
-	// Eliminate Common SubExpressions.
-	functionPassManager->add(llvm::createGVNPass());
-	// Simplify the control flow graph (deleting unreachable blocks etc).
-	functionPassManager->add(llvm::createCFGSimplificationPass());
-
-	functionPassManager->doInitialization();
-
-	functionPassManager->run(*d_gen_func);
+void CodegenVisitor::run_optimizations(OptLevel level, llvm::TargetMachine *tm) {
+#if LLVM_VERSION_MAJOR >= 14
+	using PassOptLevel = llvm::OptimizationLevel;
+#else
+	using PassOptLevel = llvm::PassBuilder::OptimizationLevel;
+#endif
+
+	//passes (e.g. the vectorizer) need to know the target
+	mod->setTargetTriple(tm->getTargetTriple().str());
+	mod->setDataLayout(tm->createDataLayout());
+
+	llvm::LoopAnalysisManager LAM;
+	llvm::FunctionAnalysisManager FAM;
+	llvm::CGSCCAnalysisManager CGAM;
+	llvm::ModuleAnalysisManager MAM;
+
+	llvm::PassBuilder PB(tm);
+	PB.registerModuleAnalyses(MAM);
+	PB.registerCGSCCAnalyses(CGAM);
+	PB.registerFunctionAnalyses(FAM);
+	PB.registerLoopAnalyses(LAM);
+	PB.crossRegisterProxies(LAM, FAM, CGAM, MAM);
+
+	llvm::ModulePassManager MPM;
+	switch (level) {
+		case OptLevel::O0:
+			MPM = PB.buildO0DefaultPipeline(PassOptLevel::O0);
+			break;
+		case OptLevel::O1:
+			MPM = PB.buildPerModuleDefaultPipeline(PassOptLevel::O1);
+			break;
+		case OptLevel::O3:
+			MPM = PB.buildPerModuleDefaultPipeline(PassOptLevel::O3);
+			break;
+		default:
+			MPM = PB.buildPerModuleDefaultPipeline(PassOptLevel::O2);
+			break;
+	}
+	MPM.run(*mod, MAM);
 }
@@ -15,8 +15,12 @@
 
 #include "ast.h"
 #include "LLVMCtx.h"
+#include "SlotTable.h"
 
-class DGen;
+class CompiledProgram;
+namespace llvm {
+class TargetMachine;
+}
 class CodegenZ3Visitor;
 
 #include "CodegenZ3Visitor.h"
@@ -25,7 +29,7 @@ class CodegenZ3Visitor;
 
 class CodegenVisitor {
 public:
-	explicit CodegenVisitor(DGen *d_gen);
+	explicit CodegenVisitor(CompiledProgram *program, Runtime *rt, const ProgramOptions &options);
 	~CodegenVisitor() = default;
 	llvm::Value *code_gen(FunctionNode *func);
 	llvm::Value *code_gen(BodyNode *body);
@@ -47,23 +51,51 @@ public:
 	llvm::Value *code_gen(ForNode *node);
 	llvm::Value *code_gen(ContinueNode *node);
 	llvm::Value *code_gen(BreakNode *node);
+	//jump to the condition of the loop, counted against the limits of the test
+	void code_gen_back_edge(ForNode *loop);
+	//address of the local variable or the element of the local array
+	llvm::Value *get_address(ASTNode *node);
 
 	bool is_last_stmt_br(BodyNode *node);
 
+	//the optimizations aren't needed when the object is taken from the cache
+	void run_optimizations(OptLevel level, llvm::TargetMachine *tm);
 	llvm::orc::ThreadSafeModule get_module();
-	DGen *d_gen;
+	//has to be passed to d_gen_func
+	SlotTable slots;
+	//see LLVMCtx::llvm_types
+	std::vector<llvm::Type*> llvm_types;
+	LLVMCtx get_ctx();
+	void reset_z3_ctx();
+	SolverCacheStats get_solver_cache_stats() const;
+	uint64_t get_solve_time_ns() const;
+	//the interpreter solves the conditions with the same visitor
+	CodegenZ3Visitor *get_z3_visitor();
+	CompiledProgram *program;
+	Runtime *rt;
 private:
 	std::unique_ptr<llvm::LLVMContext> ctx;
 	std::unique_ptr<llvm::Module> mod;
 	std::unique_ptr<llvm::IRBuilder<>> builder;
-	LLVMCtx get_ctx();
-	llvm::Value *get_address(ASTNode *node);
 	FunctionNode *func;
 	std::unique_ptr<CodegenZ3Visitor> z3_visitor;
+	//back-edges are instrumented, see TestLimits
+	bool limit_loops;
+	bool bounds_checks;
+	//branches are always solved
+	bool coverage_guided;
+	//branches are counted in Runtime::coverage (coverage_guided or collect_stats)
+	bool count_branches;
+	Coverage::Branch *add_branch(ASTNode *cond, Position pos, PrecondNode *precond);
+	void code_gen_branch_hit(Coverage::Branch *branch, llvm::Value *cond_value);
+	//aborts the test unless 0 <= idx < len of the array
+	void code_gen_bounds_check(ArrLookupNode *node, llvm::Value *data_ptr, llvm::Value *idx);
 
 	llvm::Value *convert_val_if_convertible(llvm::Value *val, Type src_t, Type dest_t);
-
-	void run_optimizations();
+	//constant array with the arena header, returns pointer to the data
+	llvm::Constant *create_const_arr(llvm::Constant *data, uint32_t len);
+	//inline load of the len from the header of runtime array
+	llvm::Value *load_arr_len(llvm::Value *data_ptr);
 };
 
 #endif //D_GEN_CODEGENVISITOR_H
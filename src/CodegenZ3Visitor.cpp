@@ -3,17 +3,71 @@
 //
 
 #include "CodegenZ3Visitor.h"
+#include "CodegenVisitor.h"
+#include "utils/timer.h"
+
+#include <chrono>
+
+//number of different models kept for every query
+#define SOLUTIONS_POOL_SIZE 8
 
 CodegenZ3Visitor::CodegenZ3Visitor(llvm::LLVMContext *ctx,
 								   llvm::Module *mod,
 								   llvm::IRBuilder<> *builder,
-								   CodegenVisitor *cg_vis):
+								   CodegenVisitor *cg_vis,
+								   Runtime *rt,
+								   Z3Encoding encoding,
+								   bool coverage_guided,
+								   bool time_solving):
 								   ctx(ctx),
 								   mod(mod),
 								   builder(builder),
 								   cg_vis(cg_vis),
-                                   exprs(z3_ctx) {
+								   rt(rt),
+								   encoding(encoding),
+								   coverage_guided(coverage_guided),
+								   time_solving(time_solving),
+                                   z3_ctx(std::make_unique<z3::context>()),
+                                   exprs(*z3_ctx),
+                                   domain(*z3_ctx) {
+	create_solver();
+}
+
+void CodegenZ3Visitor::reset() {
+	//models depend on the history of the context,
+	//so every generation run starts with a fresh one
+	syms_to_expr_id.clear();
+	//cached asts belong to the old context
+	solutions.clear();
+	solver.reset();
+	auto fresh_ctx = std::make_unique<z3::context>();
+	exprs = z3::expr_vector(*fresh_ctx);
+	domain = z3::expr_vector(*fresh_ctx);
+	z3_ctx = std::move(fresh_ctx);
+	create_solver();
+}
+
+void CodegenZ3Visitor::create_solver() {
+	z3::params p(*z3_ctx);
+	if (encoding == Z3Encoding::BIT_VECTOR) {
+		solver = std::make_unique<z3::solver>(*z3_ctx, "QF_BV");
+		//otherwise most of the models are zeros
+		p.set("phase", z3_ctx->str_symbol("random"));
+	} else {
+		//smt tactic solver re-seeds cheaply on every query, so models stay random
+		//(the incremental solver ignores a new random_seed unless it's rebuilt)
+		solver = std::make_unique<z3::solver>(z3::tactic(*z3_ctx, "smt").mk_solver());
+		p.set("arith.random_initial_value", true);
+	}
+	solver->set(p);
+}
+
+SolverCacheStats CodegenZ3Visitor::get_cache_stats() const {
+	return cache_stats;
+}
 
+uint64_t CodegenZ3Visitor::get_solve_time_ns() const {
+	return solve_time_ns;
 }
 
 //ident - addr or symbol
@@ -28,10 +82,13 @@ extern "C" void z3_gen(CodegenZ3Visitor *visitor, ASTNode *cond, PrecondNode *pr
 
 llvm::Value *CodegenZ3Visitor::prepare_eval_ctx(ASTNode *cond, PrecondNode *pre_cond) {
 	//update ptrs and indices
+	auto cb = [this](ASTNode *node) {
+		return traverse_ast_cb(node);
+	};
 	if (pre_cond) {
-		pre_cond->visitChildren(&traverse_ast_cb, this);
+		pre_cond->visitChildren(cb);
 	}
-	cond->visitChildren(&traverse_ast_cb, this);
+	cond->visitChildren(cb);
 
 	auto z3_gen_cb_t = llvm::FunctionType::get(llvm::Type::getVoidTy(*ctx),
 											   {llvm::Type::getInt8PtrTy(*ctx),
@@ -78,16 +135,10 @@ llvm::Value *CodegenZ3Visitor::prepare_eval_ctx(IdentNode *node) {
 }
 
 llvm::Value *CodegenZ3Visitor::prepare_eval_ctx(ArrLookupNode *node) {
-	//TODO: refactor this with CodegenVisitor parts
 	auto sym = node->ident->symbol;
 	if (!sym->is_input) {
-		llvm::Value *addr = sym->alloca;
-
-		for (auto &idx: node->idxs) {
-			auto ptr = builder->CreateLoad(addr->getType()->getPointerElementType(), addr);
-			addr = builder->CreateGEP(ptr->getType()->getPointerElementType(),
-									  ptr, idx->code_gen(cg_vis));
-		}
+		//z3 reads the element, so it's checked as any other access
+		auto addr = cg_vis->get_address(node);
 		auto upd_lookup_addr_t = llvm::FunctionType::get(llvm::Type::getVoidTy(*ctx),
 														 {llvm::Type::getInt8PtrTy(*ctx),
 														 llvm::Type::getInt8PtrTy(*ctx)}, false);
@@ -124,59 +175,130 @@ llvm::Value *CodegenZ3Visitor::prepare_eval_ctx(ArrLookupNode *node) {
 }
 
 LLVMCtx CodegenZ3Visitor::get_ctx() {
-	return {ctx, mod, builder};
+	return cg_vis->get_ctx();
 }
 
-bool CodegenZ3Visitor::traverse_ast_cb(ASTNode *node, std::any ctx) {
-	auto visitor = std::any_cast<CodegenZ3Visitor*>(ctx);
-	if (auto ident = dynamic_cast<IdentNode*>(node)) {
-		visitor->prepare_eval_ctx(ident);
-	} else if (auto arr_lookup = dynamic_cast<ArrLookupNode*>(node)) {
-		visitor->prepare_eval_ctx(arr_lookup);
-	} else if (auto prop_lookup = dynamic_cast<PropertyLookupNode*>(node)) {
-		visitor->prepare_eval_ctx(prop_lookup);
+bool CodegenZ3Visitor::traverse_ast_cb(ASTNode *node) {
+	if (auto ident = node_cast<IdentNode>(node)) {
+		prepare_eval_ctx(ident);
+	} else if (auto arr_lookup = node_cast<ArrLookupNode>(node)) {
+		prepare_eval_ctx(arr_lookup);
+	} else if (auto prop_lookup = node_cast<PropertyLookupNode>(node)) {
+		prepare_eval_ctx(prop_lookup);
 	}
 
 	return true;
 }
 
 void CodegenZ3Visitor::start_z3_gen(ASTNode *cond, PrecondNode *pre_cond) {
+	ScopedTimer timer(solve_time_ns, time_solving);
 	syms_to_expr_id.clear();
-    exprs = z3::expr_vector(z3_ctx);
+    exprs = z3::expr_vector(*z3_ctx);
+	domain = z3::expr_vector(*z3_ctx);
 
 	auto cond_expr = cond->gen_expr(this);
 
-	z3::tactic smt_tactic(z3_ctx, "smt");
-	auto solver = smt_tactic.mk_solver();
-	solver.set("arith.random_initial_value", true);
-	solver.set("random_seed", (unsigned int)std::rand());
+	solver->set("random_seed", rt->rng->next_uint());
+
+	//null unless coverage_guided or collect_stats
+	auto branch = rt->coverage.find(cond);
+	ConditionStats *stats = branch ? &branch->stats : nullptr;
 
-	if (pre_cond->prob != -1) {
-		auto r = std::abs(std::rand() % 100);
+	//without coverage_guided the condition is solved only with a precondition
+	if (pre_cond && pre_cond->prob != -1) {
+		auto r = (int)rt->rng->uniform(100);
 		if (r > pre_cond->prob) {
 //			std::cout << "decided to negate, recv " << r << " prob" << std::endl;
 			cond_expr = !cond_expr;
+			if (stats) {
+				stats->negated++;
+			}
+		}
+	} else if (coverage_guided && branch) {
+		//the less visited edge, a random one on a tie
+		auto false_hits = branch->hits[0];
+		auto true_hits = branch->hits[1];
+		bool to_true = true_hits < false_hits || (true_hits == false_hits && rt->rng->uniform(2));
+		if (!to_true) {
+			cond_expr = !cond_expr;
+			stats->negated++;
 		}
-	} else {
-		//todo: other method based on coverage
 	}
 
-	solver.add(cond_expr);
+	z3::expr_vector query(*z3_ctx);
+	query.push_back(cond_expr);
 
-	if (pre_cond->expr) {
+	if (pre_cond && pre_cond->expr) {
 		auto pre_cond_expr = pre_cond->expr->gen_expr(this);
-		solver.add(pre_cond_expr);
+		query.push_back(pre_cond_expr);
 	}
 
 	if (exprs.empty()) {
 //		std::cout << "exprs empty => skipping z3 gen" << std::endl;
+		if (stats) {
+			stats->skipped++;
+		}
+		return;
+	}
+
+	for (const auto &e: domain) {
+		query.push_back(e);
+	}
+
+	solve_query(query, stats);
+}
+
+void CodegenZ3Visitor::solve_query(const z3::expr_vector &query, ConditionStats *stats) {
+	std::vector<unsigned> key;
+	key.reserve(query.size());
+	for (const auto &e: query) {
+		key.push_back(e.id());
+	}
+
+	auto cached = solutions.find(key);
+	if (cached == solutions.end()) {
+		cached = solutions.emplace(std::move(key), CachedQuery{query}).first;
+	}
+	auto &entry = cached->second;
+
+	if (entry.unsat || entry.models.size() >= SOLUTIONS_POOL_SIZE) {
+		cache_stats.hits++;
+		if (stats) {
+			stats->cache_hits++;
+		}
+		if (!entry.unsat) {
+			fill_syms(entry.models[rt->rng->uniform(entry.models.size())]);
+		}
 		return;
 	}
+	cache_stats.misses++;
+
+	//the solver doesn't run past the deadline of the test
+	auto &limits = rt->limits;
+	if (limits.has_deadline()) {
+		limits.check_deadline();
+		solver->set("timeout", limits.ms_left());
+	}
+
+	//values fixed by the previous queries are constants in the expressions,
+	//so every query is scoped and the solver is left empty for the next one
+	solver->push();
+	for (const auto &e: query) {
+		solver->add(e);
+	}
 
 //	std::cout << "err: " << solver.check_error() << std::endl;
 //	std::cout << "solver " << solver << std::endl;
 
-	auto res = solver.check();
+	auto start = std::chrono::steady_clock::now();
+	auto res = solver->check();
+	if (stats) {
+		stats->solver_calls++;
+		stats->solver_time_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now() - start).count();
+		stats->unsat += res == z3::unsat;
+		stats->unknown += res == z3::unknown;
+	}
 
 	//TODO: check llvm optimization for expression like false && f_call()
 	// f_call shouldn't be invoked
@@ -184,15 +306,27 @@ void CodegenZ3Visitor::start_z3_gen(ASTNode *cond, PrecondNode *pre_cond) {
 	// (and z3 fails with unsat)
 	if (res != z3::sat) {
 //		std::cout << "couldn't check satisfiability " << res << std::endl;
+		entry.unsat = res == z3::unsat;
+		solver->pop();
+		//unknown because of the timeout
+		if (res == z3::unknown) {
+			limits.check_deadline();
+		}
 		return;
 	}
 
 //	std::cout << "satisfiability checked successfully" << std::endl;
 
-	auto model = solver.get_model();
+	auto model = solver->get_model();
+	solver->pop();
 
 //	std::cout << "model " << model.to_string() << std::endl;
 
+	entry.models.push_back(model);
+	fill_syms(model);
+}
+
+void CodegenZ3Visitor::fill_syms(const z3::model &model) {
 	for (const auto &item: syms_to_expr_id) {
 		auto sym = item.first;
 		auto expr_idx = item.second;
@@ -203,21 +337,28 @@ void CodegenZ3Visitor::start_z3_gen(ASTNode *cond, PrecondNode *pre_cond) {
 }
 
 z3::expr CodegenZ3Visitor::gen_expr(BoolNode *node) {
-	return z3_ctx.bool_val(node->val);
+	return z3_ctx->bool_val(node->val);
 }
 
 z3::expr CodegenZ3Visitor::gen_expr(CharNode *node) {
-	return z3_ctx.int_val(node->ch);
+	return num_val(node->ch, 8);
 }
 
 z3::expr CodegenZ3Visitor::gen_expr(NumberNode *node) {
-	return z3_ctx.int_val(node->num);
+	return num_val(node->num, 32);
+}
+
+z3::expr CodegenZ3Visitor::num_val(int64_t val, unsigned bits) {
+	if (encoding == Z3Encoding::BIT_VECTOR) {
+		return z3_ctx->bv_val(val, bits);
+	}
+	return z3_ctx->int_val(val);
 }
 
 z3::expr CodegenZ3Visitor::gen_expr(IdentNode *node) {
 	auto sym = node->symbol;
 	if (sym->is_input) {
-		auto expr = sym->get_expr(z3_ctx);
+		auto expr = sym->get_expr(*z3_ctx, encoding);
 		if (!sym->has_val()) {
             syms_to_expr_id[sym.get()] = exprs.size();
             exprs.push_back(expr);
@@ -232,13 +373,13 @@ z3::expr CodegenZ3Visitor::gen_expr(ArrLookupNode *node) {
 	auto sym = node->ident->symbol;
 	if (sym->is_input) {
 		auto arr_sym = std::dynamic_pointer_cast<ArraySym>(sym).get();
-		auto indexed_sym = ArraySym::get_symbol_by_idxs(arr_sym, node->current_idxs);
+		auto indexed_sym = ArraySym::get_symbol_by_idxs(arr_sym, node->current_idxs, *rt->rng);
 		std::string idx_str = "__arr_" + arr_sym->name;
 		for (auto &e: node->current_idxs) {
 			idx_str += std::to_string(e) + "_";
 		}
 		indexed_sym->name = idx_str;
-		auto expr = indexed_sym->get_expr(z3_ctx);
+		auto expr = indexed_sym->get_expr(*z3_ctx, encoding);
 		if (!indexed_sym->has_val()) {
             syms_to_expr_id[indexed_sym.get()] = exprs.size();
             exprs.push_back(expr);
@@ -255,13 +396,13 @@ z3::expr CodegenZ3Visitor::get_expr_from_void(void *ptr, Type type) {
 	switch (type.getCurrentType()) {
 		case TypeKind::INT:
 			int32 = *(int32_t*)ptr;
-			return z3_ctx.int_val(int32);
+			return num_val(int32, 32);
 		case TypeKind::CHAR:
 			int8 = *(int8_t*)ptr;
-			return z3_ctx.int_val(int8);
+			return num_val(int8, 8);
 		case TypeKind::BOOL:
 			int8 = *(int8_t*)ptr;
-			return z3_ctx.bool_val(int8 != 0);
+			return z3_ctx->bool_val(int8 != 0);
 		default:
 			throw std::runtime_error("unexpected type on gen_expr: " + type.to_string());
 	}
@@ -270,6 +411,8 @@ z3::expr CodegenZ3Visitor::get_expr_from_void(void *ptr, Type type) {
 z3::expr CodegenZ3Visitor::gen_expr(BinOpNode *node) {
 	auto lhs = node->lhs->gen_expr(this);
 	auto rhs = node->rhs->gen_expr(this);
+	//operators of z3++ on bit vectors are signed (bvslt, bvsdiv),
+	//the same as the comparisons and division in the generated code
 	switch (node->op_type) {
 		case BinOpType::SUM:
 			return lhs + rhs;
@@ -309,16 +452,22 @@ z3::expr CodegenZ3Visitor::gen_expr(PropertyLookupNode *node) {
 	auto sym = std::dynamic_pointer_cast<ArraySym>(node->ident->symbol);
 	if (sym->is_input) {
 		if (sym->inited_size.has_value()) {
-			return z3_ctx.int_val(*sym->inited_size);
+			return num_val(*sym->inited_size, 32);
 		} else {
 			auto name = sym->name + ".len";
-			auto expr = z3_ctx.int_const(name.c_str());
+			auto expr = encoding == Z3Encoding::BIT_VECTOR ? z3_ctx->bv_const(name.c_str(), 32) :
+							z3_ctx->int_const(name.c_str());
+			if (encoding == Z3Encoding::BIT_VECTOR) {
+				//negative len would be a huge array, so would be a random one near 2^31
+				domain.push_back(expr >= 0);
+				domain.push_back(expr < ARR_LEN_BOUND);
+			}
 			syms_to_expr_id[sym.get()] = exprs.size();
 			exprs.push_back(expr);
 			return expr;
 		}
 	} else {
-		auto len = Symbol::allocated_vals[*(uint8_t **)sym->addr].size;
-		return z3_ctx.int_val(len);
+		auto len = Arena::get_len(*(uint8_t **)sym->addr);
+		return num_val(len, 32);
 	}
 }
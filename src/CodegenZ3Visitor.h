@@ -9,9 +9,12 @@
 #include <llvm/IR/Module.h>
 #include <llvm/IR/IRBuilder.h>
 
+#include <map>
 #include <memory>
+#include <vector>
 
 #include "ast.h"
+#include "Stats.h"
 
 #include <z3++.h>
 
@@ -25,9 +28,15 @@ class CodegenZ3Visitor {
 public:
 	explicit CodegenZ3Visitor(llvm::LLVMContext *ctx,
 							  llvm::Module *mod,
-							  llvm::IRBuilder<> *builder, CodegenVisitor *cg_visitor);
+							  llvm::IRBuilder<> *builder, CodegenVisitor *cg_visitor,
+							  Runtime *rt, Z3Encoding encoding, bool coverage_guided, bool time_solving);
 	~CodegenZ3Visitor() = default;
 
+	void reset();
+	SolverCacheStats get_cache_stats() const;
+	//of all the z3_gen calls
+	uint64_t get_solve_time_ns() const;
+
 	llvm::Value *prepare_eval_ctx(ASTNode *cond, PrecondNode *pre_cond);
 	llvm::Value *prepare_eval_ctx(IdentNode *node);
 	llvm::Value *prepare_eval_ctx(PropertyLookupNode *node);
@@ -45,16 +54,49 @@ private:
 	llvm::Module *mod;
 	llvm::IRBuilder<> *builder;
 	CodegenVisitor *cg_vis;
+	Runtime *rt;
+	Z3Encoding encoding;
+	//polarity of the conditions without prob is picked by Runtime::coverage
+	bool coverage_guided;
+	//z3_gen calls are timed (ProgramOptions::collect_phase_times)
+	bool time_solving;
 
-	z3::context z3_ctx;
+	std::unique_ptr<z3::context> z3_ctx;
 	std::unordered_map<Symbol*, int> syms_to_expr_id;
     z3::expr_vector exprs;
+	//constraints on the values of generated symbols (e.g. len >= 0)
+	z3::expr_vector domain;
+	//every query is solved inside push/pop, so the solver is empty between them (see create_solver).
+	//for bit vectors it's the incremental QF_BV solver, which keeps its lemmas between the queries,
+	//for integers it's the smt tactic wrapped as a solver, which solves every query from scratch
+	std::unique_ptr<z3::solver> solver;
+	void create_solver();
 	void start_z3_gen(ASTNode *cond, PrecondNode *pre_cond);
+	//stats of the condition being solved, null if they are not collected
+	void solve_query(const z3::expr_vector &query, ConditionStats *stats);
+	void fill_syms(const z3::model &model);
+
+	//solutions of the queries that were already solved in the current context.
+	//z3 hash conses expressions, so structurally equal queries
+	//(with the same fixed values and polarity) have the same ast ids
+	struct CachedQuery {
+		//keeps the asts alive, so their ids aren't reused
+		z3::expr_vector query;
+		bool unsat = false;
+		//different models of the query, a random one is taken once the pool is full
+		std::vector<z3::model> models;
+	};
+	std::map<std::vector<unsigned>, CachedQuery> solutions;
+	SolverCacheStats cache_stats;
+	//with time_solving only
+	uint64_t solve_time_ns = 0;
 
 	z3::expr get_expr_from_void(void *ptr, Type type);
+	//numeral of the current encoding, bits are used for bit vectors only
+	z3::expr num_val(int64_t val, unsigned bits);
 
 	LLVMCtx get_ctx();
-	static bool traverse_ast_cb(ASTNode *node, std::any ctx);
+	bool traverse_ast_cb(ASTNode *node);
 };
 
 
@@ -0,0 +1,512 @@
+//
+// Created by Anton on 17.10.2026.
+//
+
+#include "CompiledProgram.h"
+
+#include <algorithm>
+#include <any>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#include "type.h"
+
+#include "ASTArena.h"
+#include "ASTBuilderVisitor.h"
+#include "Semantics.h"
+#include "CodegenVisitor.h"
+#include "DGenJIT.h"
+#include "Interpreter.h"
+#include "ObjectCache.h"
+#include "Runtime.h"
+#include "Serializer.h"
+#include "utils/timer.h"
+
+//tests are generated in blocks, each block starts with a fresh z3 context
+//so the blocks can be spread over the workers without changing the result
+//(every test also has its own random stream)
+#define TESTS_BLOCK_SIZE 64
+//number of blocks a worker can be ahead of the first not written block,
+//bounds the memory of the blocks waiting for their turn
+#define BLOCKS_AHEAD_PER_THREAD 2
+
+CompiledProgram::CompiledProgram(std::istream &input, ProgramOptions options):
+	source(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>()), options(options) {
+	build_ir();
+
+	switch (options.exec_mode) {
+		case ExecMode::JIT:
+			compile();
+			break;
+		case ExecMode::TIERED:
+			//the first tests don't wait for llvm, they are interpreted
+			compiler = std::thread([this]() {
+				try {
+					compile();
+				} catch (...) {
+					//d_gen_func stays null, the tests are still interpreted,
+					//the error is thrown by the next generate
+					compile_error = std::current_exception();
+					compile_failed.store(true, std::memory_order_release);
+				}
+			});
+			break;
+		case ExecMode::INTERPRETER:
+			break;
+	}
+}
+
+void CompiledProgram::compile() {
+	//ir is still generated on a cache hit, it fills the slot table of the program
+	std::string cache_key;
+	if (!options.object_cache_dir.empty()) {
+		object_cache = std::make_unique<ObjectCache>(options.object_cache_dir);
+		cache_key = ObjectCache::key(source, options);
+	}
+
+	//AUTO is left when the number of tests isn't known
+	auto level = resolve_opt_level(options.opt_level, -1);
+	uint64_t optimize_ns = 0;
+	uint64_t jit_ns = 0;
+	{
+		ScopedTimer timer(jit_ns);
+		jit = cantFail(DGenJIT::Create(level, object_cache.get()));
+	}
+	if (!object_cache || !object_cache->load(cache_key)) {
+		ScopedTimer timer(optimize_ns);
+		auto tm = cantFail(jit->createTargetMachine());
+		visitor->run_optimizations(level, tm.get());
+	}
+	{
+		ScopedTimer timer(jit_ns);
+
+		auto mod = visitor->get_module();
+		if (object_cache) {
+			mod.getModuleUnlocked()->setModuleIdentifier(cache_key);
+		}
+//		mod.getModuleUnlocked()->print(llvm::errs(), nullptr);
+
+		cantFail(jit->addModule(std::move(mod)));
+
+		d_gen_func.store((void(*)(void**))cantFail(jit->lookup(D_GEN_FUNC_NAME)).getAddress(),
+						 std::memory_order_release);
+	}
+	compile_optimize_ns.store(optimize_ns, std::memory_order_relaxed);
+	compile_jit_ns.store(jit_ns, std::memory_order_relaxed);
+}
+
+CompiledProgram::CompiledProgram(const std::string &source, ProgramOptions options, CompiledProgram *owner):
+	source(source), options(options), owner(owner) {
+	//the same ir registers its own symbols and nodes in the same slots,
+	//so the code of the main program works with them
+	build_ir();
+}
+
+void CompiledProgram::build_ir() {
+	{
+		ScopedTimer timer(times.parse_ns);
+		ast_arena = std::make_unique<ASTArena>();
+		ASTArena::Scope scope(*ast_arena);
+		std::istringstream source_stream(source);
+		auto builder = std::make_unique<ASTBuilderVisitor>(source_stream);
+		func = builder->parse();
+	}
+	{
+		ScopedTimer timer(times.semantics_ns);
+		Semantics sem(func);
+		sem.connect_loops();
+		inputs = sem.type_ast();
+		sem.type_check();
+		sem.eliminate_unreachable_code();
+	}
+	ScopedTimer timer(times.codegen_ns);
+
+	std::vector<Serializer::Column> columns;
+	for (const auto &in_sym: inputs) {
+		columns.push_back({in_sym->name, in_sym->type});
+	}
+	columns.push_back({func->name, func->ret_type});
+	serializer = Serializer::create(options.format, std::move(columns));
+	result_plan = std::make_unique<ValuePlan>(func->ret_type);
+
+	runtime = std::make_unique<Runtime>();
+	visitor = std::make_unique<CodegenVisitor>(this, runtime.get(), options);
+	visitor->code_gen(func);
+
+	if (options.exec_mode != ExecMode::JIT) {
+		interpreter = std::make_unique<Interpreter>(func, visitor.get(), runtime.get(),
+													options.coverage_guided, options.bounds_checks);
+	}
+}
+
+CompiledProgram::~CompiledProgram() {
+	if (compiler.joinable()) {
+		compiler.join();
+	}
+	workers.clear();
+	//jit code must be released before the symbols and nodes it points to
+	jit.reset();
+	visitor.reset();
+	inputs.clear();
+	ast_arena.reset();
+}
+
+std::string CompiledProgram::generate(int tests_num, std::optional<int> seed, int threads) {
+	std::ostringstream out;
+	OStreamSink sink(out);
+	generate(tests_num, seed, sink, threads);
+	return out.str();
+}
+
+void CompiledProgram::generate(int tests_num, std::optional<int> seed, Sink &sink, int threads) {
+	//only once, the next calls go on interpreting
+	if (compile_failed.exchange(false, std::memory_order_acquire)) {
+		std::rethrow_exception(std::move(compile_error));
+	}
+
+	if (!seed.has_value()) {
+		seed = time(NULL);
+	}
+
+	int blocks_num = (tests_num + TESTS_BLOCK_SIZE - 1) / TESTS_BLOCK_SIZE;
+	threads = std::max(1, std::min(threads, blocks_num));
+	prepare_workers(threads - 1);
+
+	sink.write(serializer->header());
+
+	//blocks are written in order, the ones generated ahead wait in pending
+	std::mutex mtx;
+	std::condition_variable written_cv;
+	struct PendingBlock {
+		std::string text;
+		size_t tests_num = 0;
+		//kept to cut the block after the test that completes the coverage
+		std::vector<std::vector<std::string>> tests;
+		std::vector<std::vector<uint32_t>> edges;
+	};
+	std::map<int, PendingBlock> pending;
+	int next_to_write = 0;
+	size_t written_tests = 0;
+	bool stop = false;
+	int max_ahead = threads * BLOCKS_AHEAD_PER_THREAD;
+
+	bool stop_when_covered = options.coverage_guided && options.stop_when_covered;
+	std::vector<bool> covered(runtime->coverage.edges_num());
+	size_t covered_num = 0;
+
+	std::atomic<int> next_block = 0;
+	std::vector<std::exception_ptr> errors(threads);
+
+	//true if the block completes the coverage, the tests after that are left out
+	auto cut_covered = [&](PendingBlock &block) {
+		for (size_t i = 0; i < block.edges.size(); i++) {
+			for (auto edge: block.edges[i]) {
+				if (!covered[edge]) {
+					covered[edge] = true;
+					covered_num++;
+				}
+			}
+			if (covered_num == covered.size()) {
+				if (i + 1 < block.tests.size()) {
+					block.tests.resize(i + 1);
+					block.text.clear();
+					serializer->write_block(block.text, block.tests);
+				}
+				block.tests_num = i + 1;
+				return true;
+			}
+		}
+		return false;
+	};
+
+	auto write_ready = [&]() {
+		for (auto it = pending.find(next_to_write); it != pending.end() && !stop; it = pending.find(next_to_write)) {
+			auto &block = it->second;
+			if (stop_when_covered && cut_covered(block)) {
+				//the workers are done, the blocks generated ahead are thrown away
+				stop = true;
+				next_block = blocks_num;
+			}
+			//a block can be empty when all its tests are dropped
+			if (block.tests_num > 0) {
+				if (written_tests > 0) {
+					sink.write(serializer->block_separator());
+				}
+				sink.write(block.text);
+				written_tests += block.tests_num;
+			}
+			pending.erase(it);
+			next_to_write++;
+		}
+	};
+
+	auto work = [&](CompiledProgram *program, int worker) {
+		std::vector<std::vector<std::string>> tests;
+		std::vector<std::vector<uint32_t>> edges;
+		try {
+			for (int block = next_block++; block < blocks_num; block = next_block++) {
+				{
+					std::unique_lock<std::mutex> lock(mtx);
+					written_cv.wait(lock, [&]() { return stop || block < next_to_write + max_ahead; });
+					if (stop) {
+						return;
+					}
+				}
+
+				program->generate_block(block, tests_num, *seed, tests, stop_when_covered ? &edges : nullptr);
+				//dropped tests have no cells
+				size_t kept = 0;
+				for (size_t i = 0; i < tests.size(); i++) {
+					if (tests[i].empty()) {
+						continue;
+					}
+					tests[kept] = std::move(tests[i]);
+					if (stop_when_covered) {
+						edges[kept] = std::move(edges[i]);
+					}
+					kept++;
+				}
+				tests.resize(kept);
+
+				PendingBlock pending_block;
+				{
+					ScopedTimer timer(program->times.serialize_ns);
+					program->serializer->write_block(pending_block.text, tests);
+				}
+				pending_block.tests_num = tests.size();
+				if (stop_when_covered) {
+					edges.resize(kept);
+					pending_block.tests = std::move(tests);
+					pending_block.edges = std::move(edges);
+				}
+
+				std::lock_guard<std::mutex> lock(mtx);
+				pending.emplace(block, std::move(pending_block));
+				write_ready();
+				written_cv.notify_all();
+			}
+		} catch (...) {
+			//stop the other workers
+			next_block = blocks_num;
+			std::lock_guard<std::mutex> lock(mtx);
+			stop = true;
+			written_cv.notify_all();
+			errors[worker] = std::current_exception();
+		}
+	};
+
+	std::vector<std::thread> pool;
+	pool.reserve(threads - 1);
+	for (int i = 1; i < threads; i++) {
+		pool.emplace_back(work, workers[i - 1].get(), i);
+	}
+	work(this, 0);
+	for (auto &t: pool) {
+		t.join();
+	}
+
+	for (auto &err: errors) {
+		if (err) {
+			std::rethrow_exception(err);
+		}
+	}
+
+	sink.write(serializer->footer(written_tests > 0));
+	sink.flush();
+}
+
+std::string CompiledProgram::generate_test(int test_idx, int seed) {
+	//z3 context of the test's block has to go through the same history,
+	//so the block is replayed up to the test
+	std::vector<std::vector<std::string>> tests;
+	generate_block(test_idx / TESTS_BLOCK_SIZE, test_idx + 1, seed, tests);
+	if (tests.back().empty()) {
+		throw std::runtime_error("test " + std::to_string(test_idx) + " is dropped");
+	}
+	std::string test;
+	serializer->write_test(test, tests.back());
+	return test;
+}
+
+void CompiledProgram::generate_block(int block, int tests_num, int seed, std::vector<std::vector<std::string>> &tests,
+									 std::vector<std::vector<uint32_t>> *edges) {
+	visitor->reset_z3_ctx();
+	//the coverage guidance starts over with the z3 context
+	auto &coverage = runtime->coverage;
+	coverage.reset();
+	std::vector<uint64_t> hits_before;
+
+	int begin = block * TESTS_BLOCK_SIZE;
+	int end = std::min(tests_num, (block + 1) * TESTS_BLOCK_SIZE);
+	tests.assign(std::max(end - begin, 0), std::vector<std::string>());
+	if (edges) {
+		edges->assign(tests.size(), std::vector<uint32_t>());
+	}
+	try {
+		for (int i = begin; i < end; i++) {
+			cur_test = &tests[i - begin];
+			for (int attempt = 0; ; attempt++) {
+				//retries take other streams, the first one is the stream of the test
+				runtime->rng->seed(seed, (uint64_t)attempt << 32 | (uint32_t)i);
+				runtime->limits.start(options);
+				//to find the edges of the test and to take back the hits of an aborted attempt
+				if (options.coverage_guided) {
+					hits_before.resize(coverage.edges_num());
+					for (size_t edge = 0; edge < hits_before.size(); edge++) {
+						hits_before[edge] = coverage.get_hits(edge);
+					}
+				}
+				try {
+					run_test();
+					if (edges) {
+						for (size_t edge = 0; edge < hits_before.size(); edge++) {
+							if (coverage.get_hits(edge) != hits_before[edge]) {
+								(*edges)[i - begin].push_back(edge);
+							}
+						}
+					}
+					reset();
+					break;
+				} catch (const TestAborted &e) {
+					//cells are gathered on return, so the aborted test has none
+					reset();
+					for (size_t edge = 0; edge < hits_before.size(); edge++) {
+						coverage.set_hits(edge, hits_before[edge]);
+					}
+					switch (e.reason) {
+						case TestAborted::LOOP_BUDGET:
+							limit_stats.over_budget++;
+							break;
+						case TestAborted::TIMEOUT:
+							limit_stats.timed_out++;
+							break;
+						case TestAborted::OUT_OF_BOUNDS:
+							limit_stats.out_of_bounds++;
+							break;
+					}
+					if (attempt >= options.abort_retries) {
+						limit_stats.dropped++;
+						break;
+					}
+					limit_stats.retries++;
+				}
+			}
+		}
+	} catch (...) {
+		//leave the program ready for the next run
+		reset();
+		throw;
+	}
+	cur_test = nullptr;
+}
+
+void CompiledProgram::run_test() {
+	ScopedTimer timer(run_ns, options.collect_phase_times);
+	//the interpreter makes the same calls, so switching in the middle doesn't change the tests
+	auto compiled = owner->d_gen_func.load(std::memory_order_acquire);
+	if (compiled) {
+		compiled(visitor->slots.data());
+	} else {
+		interpreter->run();
+	}
+}
+
+SolverCacheStats CompiledProgram::solver_cache_stats() const {
+	auto stats = visitor->get_solver_cache_stats();
+	for (const auto &worker: workers) {
+		stats += worker->solver_cache_stats();
+	}
+	return stats;
+}
+
+TestLimitStats CompiledProgram::test_limit_stats() const {
+	auto stats = limit_stats;
+	for (const auto &worker: workers) {
+		stats += worker->test_limit_stats();
+	}
+	return stats;
+}
+
+std::vector<ConditionStats> CompiledProgram::condition_stats() const {
+	//workers register the same branches in the same order
+	auto stats = runtime->coverage.get_stats();
+	for (const auto &worker: workers) {
+		auto worker_stats = worker->condition_stats();
+		for (size_t i = 0; i < stats.size(); i++) {
+			stats[i] += worker_stats[i];
+		}
+	}
+	return stats;
+}
+
+PhaseTimes CompiledProgram::phase_times() const {
+	auto res = times;
+	//0 while the compile of ExecMode::TIERED is running
+	res.optimize_ns = compile_optimize_ns.load(std::memory_order_relaxed);
+	res.jit_ns = compile_jit_ns.load(std::memory_order_relaxed);
+	res.solve_ns = visitor->get_solve_time_ns();
+	res.serialize_ns += gather_ns;
+	//the solving and gather_res are called by the tests
+	res.execute_ns = run_ns - std::min(run_ns, res.solve_ns + gather_ns);
+	for (const auto &worker: workers) {
+		res += worker->phase_times();
+	}
+	return res;
+}
+
+void CompiledProgram::prepare_workers(int num) {
+	if (workers.size() >= num) {
+		return;
+	}
+
+	auto first_new = workers.size();
+	workers.resize(num);
+
+	//workers share the compiled code, but have their own symbols and nodes,
+	//they are built in parallel
+	std::vector<std::thread> compilers;
+	std::vector<std::exception_ptr> errors(num);
+	for (auto i = first_new; i < num; i++) {
+		compilers.emplace_back([this, &errors, i]() {
+			try {
+				workers[i] = std::unique_ptr<CompiledProgram>(new CompiledProgram(source, options, this));
+			} catch (...) {
+				errors[i] = std::current_exception();
+			}
+		});
+	}
+	for (auto &t: compilers) {
+		t.join();
+	}
+
+	for (auto &err: errors) {
+		if (err) {
+			workers.resize(first_new);
+			std::rethrow_exception(err);
+		}
+	}
+}
+
+void CompiledProgram::gather_res(void *res) {
+	ScopedTimer timer(gather_ns, options.collect_phase_times);
+	auto &cells = *cur_test;
+	cells.resize(inputs.size() + 1);
+	for (int i = 0; i < inputs.size(); i++) {
+		inputs[i]->serialize(*runtime, *serializer, cells[i]);
+	}
+
+	result_plan->write(*serializer, cells.back(), (const uint8_t*)res);
+}
+
+void CompiledProgram::reset() {
+	runtime->arena.reset();
+
+	for (auto &arg: inputs) {
+		arg->reset_val();
+	}
+}
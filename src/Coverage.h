@@ -0,0 +1,84 @@
+//
+// Created by Anton on 17.10.2026.
+//
+
+#ifndef D_GEN_COVERAGE_H
+#define D_GEN_COVERAGE_H
+
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+#include "Position.h"
+#include "Stats.h"
+
+class ASTNode;
+
+//hits of the branch edges (the condition is true or false) of the ifs and loops.
+//branches are registered by codegen in the same order for the same program,
+//the edge of the value v of the i-th branch is 2*i + v.
+//with coverage_guided the hits of an aborted attempt of a test are taken back (see set_hits),
+//so only the kept tests guide the generation (and are counted in the true/false counts of the stats)
+class Coverage {
+public:
+	struct Branch {
+		//indexed by the value of the condition, since the last reset()
+		uint64_t hits[2] = {0, 0};
+		//of all the runs, the hits are added on reset()
+		ConditionStats stats;
+	};
+
+	//the counters don't move, the generated code increments them in place
+	Branch *add_branch(ASTNode *cond, Position pos, bool has_precond) {
+		branches.emplace_back();
+		auto &branch = branches.back();
+		branch.stats.line = pos.line;
+		branch.stats.col = pos.col;
+		branch.stats.has_precond = has_precond;
+		by_cond[cond] = &branch;
+		return &branch;
+	}
+
+	Branch *find(ASTNode *cond) {
+		auto it = by_cond.find(cond);
+		return it != by_cond.end() ? it->second : nullptr;
+	}
+
+	size_t edges_num() const {
+		return branches.size() * 2;
+	}
+
+	uint64_t get_hits(size_t edge) const {
+		return branches[edge / 2].hits[edge % 2];
+	}
+
+	void set_hits(size_t edge, uint64_t hits) {
+		branches[edge / 2].hits[edge % 2] = hits;
+	}
+
+	void reset() {
+		for (auto &branch: branches) {
+			branch.stats.false_count += branch.hits[0];
+			branch.stats.true_count += branch.hits[1];
+			branch.hits[0] = branch.hits[1] = 0;
+		}
+	}
+
+	//in the order of the branches
+	std::vector<ConditionStats> get_stats() const {
+		std::vector<ConditionStats> res;
+		res.reserve(branches.size());
+		for (const auto &branch: branches) {
+			res.push_back(branch.stats);
+			res.back().false_count += branch.hits[0];
+			res.back().true_count += branch.hits[1];
+		}
+		return res;
+	}
+private:
+	std::deque<Branch> branches;
+	std::unordered_map<ASTNode*, Branch*> by_cond;
+};
+
+#endif //D_GEN_COVERAGE_H
@@ -6,140 +6,31 @@
 
 #include "DGen.h"
 
-#include <any>
-#include <cstdlib>
+DGen::DGen(std::istream &input, ProgramOptions options): input(input), options(options) {}
 
-#include "type.h"
-
-#include "ASTBuilderVisitor.h"
-#include "Semantics.h"
-#include "CodegenVisitor.h"
-#include "DGenJIT.h"
-
-DGen::DGen(std::istream &input): input(input) {}
-
-std::string DGen::generate_json(int tests_num, std::optional<int> seed) {
-	auto builder = std::make_unique<ASTBuilderVisitor>(input);
-	func = builder->parse();
-	Semantics sem(func);
-	sem.connect_loops();
-	inputs = sem.type_ast();
-	sem.type_check();
-	sem.eliminate_unreachable_code();
-
-	if (!seed.has_value()) {
-		seed = time(NULL);
-	}
-
-	std::srand(*seed);
-
-	CodegenVisitor visitor(this);
-	visitor.code_gen(func);
-
-	auto mod = visitor.get_module();
-//	mod.getModuleUnlocked()->print(llvm::errs(), nullptr);
-
-	auto J = cantFail(DGenJIT::Create());
-	cantFail(J->addModule(std::move(mod)));
-
-	auto d_gen_func = (void(*)())cantFail(J->lookup(D_GEN_FUNC_NAME)).getAddress();
-
-	//loop
-	tests.clear();
-	tests.reserve(tests_num);
-	for (int i = 0; i < tests_num; i++) {
-		d_gen_func();
-		reset();
-	}
-
-	delete func;
-
-	std::string json_res = "{\n\t\"tests\": [\n";
-
-	for (int i = 0; i < tests.size(); i++) {
-		json_res += "\t" + tests[i];
-		if (i != tests.size()-1) {
-			json_res += ",";
-		}
-		json_res += "\n";
-	}
-
-	json_res += "\t]\n}";
-
-	return json_res;
+std::string DGen::generate_json(int tests_num, std::optional<int> seed, int threads) {
+	return compile(tests_num).generate(tests_num, seed, threads);
 }
 
-std::string gather_rec(void *res, Type type) {
-	int32_t num;
-	uint8_t *str_ptr, *arr_ptr;
-	uint32_t size;
-	uint8_t ch;
-	std::string tmp;
-	int type_size;
-
-	switch (type.getCurrentType()) {
-		case TypeKind::INT:
-			num = *(int32_t*)res;
-			return std::to_string(num);
-		case TypeKind::STRING:
-			str_ptr = *(uint8_t**)res;
-			size = Symbol::allocated_vals[str_ptr].size;
-			//TODO: escape json
-			return "\"" + std::string((const char*)str_ptr, size) + "\"";
-		case TypeKind::CHAR:
-			ch = *(uint8_t*)res;
-			return std::to_string((char)ch);
-		case TypeKind::BOOL:
-			ch = *(uint8_t*)res;
-			if (ch) {
-				return "true";
-			} else {
-				return "false";
-			}
-		case TypeKind::ARR:
-			arr_ptr = *(uint8_t**)res;
-			size = Symbol::allocated_vals[arr_ptr].size;
-			type_size = Symbol::create_symbol(Position(0, 0), type.dropType(), "tmp")->get_sizeof();
-			tmp = "[";
-			for (int i = 0; i < size; i++) {
-				tmp += gather_rec(arr_ptr + i*type_size, type.dropType());
-				if (i + 1 != size) {
-					tmp += + ",";
-				}
-			}
-			tmp += ']';
-			return tmp;
-	}
-
-	return "";
+void DGen::generate_json(int tests_num, std::optional<int> seed, Sink &sink, int threads) {
+	compile(tests_num).generate(tests_num, seed, sink, threads);
 }
 
-void DGen::gather_res(void *res) {
-	std::string test_data = "{\n";
-	for (const auto &in_sym: inputs) {
-		test_data += "\t\t\"" + in_sym->name + "\": ";
-		test_data += in_sym->serialize();
-		test_data += ",\n";
-	}
-
-	auto res_str = gather_rec(res, func->ret_type);
-	test_data += "\t\t\"" + func->name + "\": " + res_str;
-	test_data += "\n\t}";
-
-	tests.push_back(std::move(test_data));
+std::vector<ConditionStats> DGen::condition_stats() const {
+	return program ? program->condition_stats() : std::vector<ConditionStats>();
 }
 
-void DGen::reset() {
-	for (auto &item: Symbol::allocated_vals) {
-		if (item.second.is_alloc) {
-			free(item.first);
-		}
-	}
-	Symbol::allocated_vals.clear();
+CompiledProgram &DGen::compile() {
+	return compile(-1);
+}
 
-	for (auto &arg: inputs) {
-		arg->reset_val();
+CompiledProgram &DGen::compile(int tests_num) {
+	if (!program) {
+		//the first request decides the level of AUTO
+		options.opt_level = resolve_opt_level(options.opt_level, tests_num);
+		program = std::make_unique<CompiledProgram>(input, options);
 	}
+	return *program;
 }
 
 void DGen::init_backend() {
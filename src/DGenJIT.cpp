@@ -5,13 +5,14 @@
 #include "DGenJIT.h"
 
 DGenJIT::DGenJIT(std::unique_ptr<llvm::orc::ExecutionSession> ES, llvm::orc::JITTargetMachineBuilder JTMB,
-				 llvm::DataLayout DL)
+				 llvm::DataLayout DL, llvm::ObjectCache *cache)
 		: ES(std::move(ES)), DL(std::move(DL)), Mangle(*this->ES, this->DL),
 		  ObjectLayer(*this->ES,
 					  []() { return std::make_unique<llvm::SectionMemoryManager>(); }),
 		  CompileLayer(*this->ES, ObjectLayer,
-					   std::make_unique<llvm::orc::ConcurrentIRCompiler>(std::move(JTMB))),
-		  MainJD(this->ES->createBareJITDylib("<main>")) {
+					   std::make_unique<llvm::orc::ConcurrentIRCompiler>(JTMB, cache)),
+		  MainJD(this->ES->createBareJITDylib("<main>")),
+		  JTMB(std::move(JTMB)) {
 	MainJD.addGenerator(
 			cantFail(llvm::orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(
 					this->DL.getGlobalPrefix())));
@@ -22,22 +23,40 @@ DGenJIT::~DGenJIT() {
 		ES->reportError(std::move(Err));
 }
 
-llvm::Expected<std::unique_ptr<DGenJIT>> DGenJIT::Create() {
+llvm::Expected<std::unique_ptr<DGenJIT>> DGenJIT::Create(OptLevel level, llvm::ObjectCache *cache) {
 	auto EPC = llvm::orc::SelfExecutorProcessControl::Create();
 	if (!EPC)
 		return EPC.takeError();
 
 	auto ES = std::make_unique<llvm::orc::ExecutionSession>(std::move(*EPC));
 
-	llvm::orc::JITTargetMachineBuilder JTMB(
-			ES->getExecutorProcessControl().getTargetTriple());
+	//host cpu name and features
+	auto host = llvm::orc::JITTargetMachineBuilder::detectHost();
+	if (!host)
+		return host.takeError();
+	auto JTMB = std::move(*host);
+
+	switch (level) {
+		case OptLevel::O0:
+			JTMB.setCodeGenOptLevel(llvm::CodeGenOpt::None);
+			break;
+		case OptLevel::O1:
+			JTMB.setCodeGenOptLevel(llvm::CodeGenOpt::Less);
+			break;
+		case OptLevel::O3:
+			JTMB.setCodeGenOptLevel(llvm::CodeGenOpt::Aggressive);
+			break;
+		default:
+			JTMB.setCodeGenOptLevel(llvm::CodeGenOpt::Default);
+			break;
+	}
 
 	auto DL = JTMB.getDefaultDataLayoutForTarget();
 	if (!DL)
 		return DL.takeError();
 
 	return std::make_unique<DGenJIT>(std::move(ES), std::move(JTMB),
-									 std::move(*DL));
+									 std::move(*DL), cache);
 }
 
 llvm::Error DGenJIT::addModule(llvm::orc::ThreadSafeModule TSM, llvm::orc::ResourceTrackerSP RT) {
@@ -50,6 +69,10 @@ llvm::Expected<llvm::JITEvaluatedSymbol> DGenJIT::lookup(llvm::StringRef Name) {
 	return ES->lookup({&MainJD}, Mangle(Name.str()));
 }
 
+llvm::Expected<std::unique_ptr<llvm::TargetMachine>> DGenJIT::createTargetMachine() {
+	return JTMB.createTargetMachine();
+}
+
 const llvm::DataLayout &DGenJIT::getDataLayout() const { return DL; }
 
 llvm::orc::JITDylib &DGenJIT::getMainJITDylib() { return MainJD; }
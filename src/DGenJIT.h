@@ -13,9 +13,13 @@
 #include "llvm/ExecutionEngine/Orc/IRCompileLayer.h"
 #include "llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h"
 #include "llvm/ExecutionEngine/Orc/RTDyldObjectLinkingLayer.h"
+#include "llvm/ExecutionEngine/ObjectCache.h"
 #include "llvm/ExecutionEngine/SectionMemoryManager.h"
 #include "llvm/IR/DataLayout.h"
 #include "llvm/IR/LLVMContext.h"
+#include "llvm/Target/TargetMachine.h"
+
+#include "Options.h"
 
 
 #include <memory>
@@ -32,13 +36,21 @@ private:
 
 	llvm::orc::JITDylib &MainJD;
 
+	//copy of the builder given to the compiler, for the optimization passes
+	llvm::orc::JITTargetMachineBuilder JTMB;
+
 public:
 	DGenJIT(std::unique_ptr<llvm::orc::ExecutionSession> ES,
-			llvm::orc::JITTargetMachineBuilder JTMB, llvm::DataLayout DL);
+			llvm::orc::JITTargetMachineBuilder JTMB, llvm::DataLayout DL,
+			llvm::ObjectCache *cache = nullptr);
 
 	~DGenJIT();
 
-	static llvm::Expected<std::unique_ptr<DGenJIT>> Create();
+	//targets the host cpu, compiled objects are taken from and stored to the cache if it's given
+	static llvm::Expected<std::unique_ptr<DGenJIT>> Create(OptLevel level = OptLevel::O2,
+														   llvm::ObjectCache *cache = nullptr);
+
+	llvm::Expected<std::unique_ptr<llvm::TargetMachine>> createTargetMachine();
 
 	const llvm::DataLayout &getDataLayout() const;
 
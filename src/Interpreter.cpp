@@ -0,0 +1,392 @@
+//
+// Created by Anton on 17.10.2026.
+//
+
+#include "Interpreter.h"
+
+#include <cstring>
+
+#include "utils/assert.h"
+
+#include "Arena.h"
+#include "CodegenVisitor.h"
+#include "CompiledProgram.h"
+#include "Runtime.h"
+
+//callbacks of the generated code
+extern "C" uint8_t *arr_rand_gen(ArraySym *arr, Runtime *rt);
+extern "C" int8_t bool_rand_gen(BoolSym *sym, Runtime *rt);
+extern "C" int32_t num_rand_gen(NumberSym *sym, Runtime *rt);
+extern "C" int8_t char_rand_gen(CharSym *sym, Runtime *rt);
+extern "C" void get_val_arr(ArraySym *arr, int *idxs, int len, uint8_t *dest, Runtime *rt);
+extern "C" uint32_t get_property(PropertyLookupNode *node, Runtime *rt);
+extern "C" uint8_t *create_arr(int32_t len, uint32_t pointed_sizeof, Runtime *rt);
+extern "C" uint8_t *create_arr_of_arrs(int32_t len, Runtime *rt);
+extern "C" void out_of_bounds(ArrLookupNode *node, int32_t idx, uint32_t len);
+
+Interpreter::Interpreter(FunctionNode *func, CodegenVisitor *visitor, Runtime *rt,
+						 bool coverage_guided, bool bounds_checks):
+	func(func), visitor(visitor), rt(rt), coverage_guided(coverage_guided), bounds_checks(bounds_checks) {}
+
+void Interpreter::run() {
+	flow = Flow::NEXT;
+	eval(func->body);
+}
+
+InterpValue Interpreter::eval(BodyNode *body) {
+	for (auto stmt: body->stmts) {
+		stmt->eval(this);
+		if (flow != Flow::NEXT) {
+			break;
+		}
+	}
+
+	return {};
+}
+
+InterpValue Interpreter::eval(BoolNode *node) {
+	return {node->val};
+}
+
+InterpValue Interpreter::eval(NumberNode *node) {
+	return {node->num};
+}
+
+InterpValue Interpreter::eval(StringNode *node) {
+	auto it = strings.find(node);
+	if (it == strings.end()) {
+		//null terminated as the constant of the generated code, len doesn't count the terminator
+		auto words = (sizeof(ArrHeader) + node->str.size() + 1 + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+		std::vector<uint64_t> buf(words, 0);
+		auto header = reinterpret_cast<ArrHeader*>(buf.data());
+		header->len = node->str.size();
+		std::memcpy(header + 1, node->str.data(), node->str.size());
+		it = strings.emplace(node, std::move(buf)).first;
+	}
+
+	return {0, reinterpret_cast<uint8_t*>(it->second.data()) + sizeof(ArrHeader)};
+}
+
+InterpValue Interpreter::eval(CharNode *node) {
+	return {node->ch};
+}
+
+InterpValue Interpreter::eval(BinOpNode *node) {
+	auto lhs = node->lhs->eval(this);
+	auto rhs = node->rhs->eval(this);
+	//arithmetic of the generated code wraps around in the width of the operands
+	auto wrap = [&](uint32_t res) -> InterpValue {
+		if (node->lhs->get_type() == TypeKind::CHAR) {
+			return {(int8_t)res};
+		}
+		return {(int32_t)res};
+	};
+
+	switch (node->op_type) {
+		case BinOpType::SUM:
+			return wrap((uint32_t)lhs.num + (uint32_t)rhs.num);
+		case BinOpType::SUB:
+			return wrap((uint32_t)lhs.num - (uint32_t)rhs.num);
+		case BinOpType::MUL:
+			return wrap((uint32_t)lhs.num * (uint32_t)rhs.num);
+		case BinOpType::DIV:
+			return wrap((uint32_t)((int64_t)lhs.num / rhs.num));
+		case BinOpType::OR:
+			return {lhs.num | rhs.num};
+		case BinOpType::AND:
+			return {lhs.num & rhs.num};
+		case BinOpType::LT:
+			return {lhs.num < rhs.num};
+		case BinOpType::LE:
+			return {lhs.num <= rhs.num};
+		case BinOpType::GT:
+			return {lhs.num > rhs.num};
+		case BinOpType::GE:
+			return {lhs.num >= rhs.num};
+		case BinOpType::EQ:
+			return {lhs.num == rhs.num && lhs.ptr == rhs.ptr};
+		case BinOpType::NEQ:
+			return {lhs.num != rhs.num || lhs.ptr != rhs.ptr};
+	}
+	ASSERT(false, "unknown bin op");
+}
+
+InterpValue Interpreter::eval(IdentNode *node) {
+	auto symbol = node->symbol.get();
+
+	if (!symbol->is_input) {
+		return load(get_storage(symbol), symbol->type);
+	}
+
+	switch (symbol->type.getCurrentType()) {
+		case TypeKind::INT:
+			return {num_rand_gen(static_cast<NumberSym*>(symbol), rt)};
+		case TypeKind::CHAR:
+			return {char_rand_gen(static_cast<CharSym*>(symbol), rt)};
+		case TypeKind::BOOL:
+			return {bool_rand_gen(static_cast<BoolSym*>(symbol), rt)};
+		default:
+			return {0, arr_rand_gen(static_cast<ArraySym*>(symbol), rt)};
+	}
+}
+
+InterpValue Interpreter::eval(DefNode *node) {
+	auto storage = get_storage(node->sym.get());
+	if (!node->rhs) {
+		if (node->type.getCurrentType() == TypeKind::ARR || node->type.getCurrentType() == TypeKind::STRING) {
+			//not initialized arrays are empty
+			store(storage, node->type, {0, reinterpret_cast<uint8_t*>(&empty_arr[1])});
+		}
+		return {};
+	}
+
+	auto rhs = node->rhs->eval(this);
+	rhs = convert_val_if_convertible(rhs, node->rhs->get_type(), node->type);
+	store(storage, node->type, rhs);
+
+	return {};
+}
+
+InterpValue Interpreter::eval(ReturnNode *node) {
+	uint64_t res = 0;
+	store(reinterpret_cast<uint8_t*>(&res), func->ret_type, node->expr->eval(this));
+	gather_res(visitor, &res);
+	flow = Flow::RETURN;
+	return {};
+}
+
+InterpValue Interpreter::eval(AsgNode *node) {
+	auto addr = get_address(node->lhs);
+	auto rhs = node->rhs->eval(this);
+	rhs = convert_val_if_convertible(rhs, node->rhs->get_type(), node->lhs->get_type());
+	store(addr, node->lhs->get_type(), rhs);
+	return {};
+}
+
+InterpValue Interpreter::eval(ArrLookupNode *node) {
+	auto symbol = node->ident->symbol.get();
+
+	if (!symbol->is_input) {
+		return load(get_address(node), node->get_type());
+	}
+
+	std::vector<int> idxs;
+	idxs.reserve(node->idxs.size());
+	for (const auto &idx: node->idxs) {
+		idxs.push_back(idx->eval(this).num);
+	}
+
+	uint64_t dest = 0;
+	get_val_arr(static_cast<ArraySym*>(symbol), idxs.data(), idxs.size(), reinterpret_cast<uint8_t*>(&dest), rt);
+	return load(reinterpret_cast<uint8_t*>(&dest), node->get_type());
+}
+
+InterpValue Interpreter::eval(PropertyLookupNode *node) {
+	auto symbol = node->ident->symbol.get();
+	if (!symbol->is_input) {
+		auto data = load(get_storage(symbol), symbol->type).ptr;
+		return {(int32_t)Arena::get_len(data)};
+	}
+
+	//size of the input array may be not generated yet
+	return {(int32_t)get_property(node, rt)};
+}
+
+InterpValue Interpreter::eval(ArrCreateNode *node) {
+	auto len = node->len->eval(this);
+	auto elem_type = node->type.dropType();
+	if (elem_type.getCurrentType() == TypeKind::ARR || elem_type.getCurrentType() == TypeKind::STRING) {
+		return {0, create_arr_of_arrs(len.num, rt)};
+	}
+	return {0, create_arr(len.num, get_sizeof(elem_type), rt)};
+}
+
+InterpValue Interpreter::eval(IfNode *node) {
+	if (eval_cond(node->cond, node->precond)) {
+		eval(node->body);
+	} else if (node->else_body) {
+		eval(node->else_body);
+	}
+
+	return {};
+}
+
+InterpValue Interpreter::eval(ForNode *node) {
+	if (node->pre_asg) {
+		eval(node->pre_asg);
+	}
+
+	while (true) {
+		if (!eval_cond(node->cond, node->precond)) {
+			break;
+		}
+
+		eval(node->body);
+		if (flow == Flow::BREAK) {
+			flow = Flow::NEXT;
+			break;
+		} else if (flow == Flow::RETURN) {
+			break;
+		} else if (flow == Flow::CONTINUE) {
+			//continue jumps straight to the condition
+			flow = Flow::NEXT;
+			back_edge();
+			continue;
+		}
+
+		if (node->inc_asg) {
+			eval(node->inc_asg);
+		}
+		back_edge();
+	}
+
+	return {};
+}
+
+InterpValue Interpreter::eval(ContinueNode *node) {
+	flow = Flow::CONTINUE;
+	return {};
+}
+
+InterpValue Interpreter::eval(BreakNode *node) {
+	flow = Flow::BREAK;
+	return {};
+}
+
+bool Interpreter::eval_cond(ASTNode *cond, PrecondNode *pre_cond) {
+	if (pre_cond || coverage_guided) {
+		prepare_eval_ctx(cond, pre_cond);
+	}
+
+	bool val = cond->eval(this).num != 0;
+	//registered by codegen when the generated code counts it
+	if (auto branch = rt->coverage.find(cond)) {
+		branch->hits[val]++;
+	}
+	return val;
+}
+
+void Interpreter::back_edge() {
+	if (--rt->limits.steps_left < 0) {
+		rt->limits.check();
+	}
+}
+
+uint8_t *Interpreter::get_storage(Symbol *sym) {
+	return reinterpret_cast<uint8_t*>(&locals[sym]);
+}
+
+uint8_t *Interpreter::get_address(ASTNode *node) {
+	if (auto ident = node_cast<IdentNode>(node)) {
+		return get_storage(ident->symbol.get());
+	} else if (auto lookup = node_cast<ArrLookupNode>(node)) {
+		auto sym = lookup->ident->symbol.get();
+		auto addr = get_storage(sym);
+		auto type = sym->type;
+
+		for (auto &idx: lookup->idxs) {
+			auto ptr = load(addr, type).ptr;
+			auto idx_val = idx->eval(this).num;
+			//only with ProgramOptions::bounds_checks as in the generated code,
+			//otherwise the test would be aborted here and not in the jit
+			if (bounds_checks) {
+				auto len = Arena::get_len(ptr);
+				if ((uint32_t)idx_val >= len) {
+					out_of_bounds(lookup, idx_val, len);
+				}
+			}
+			type = type.dropType();
+			addr = ptr + (int64_t)idx_val * get_sizeof(type);
+		}
+
+		return addr;
+	}
+
+	ASSERT(false, "expected ident or array lookup node on the left side");
+}
+
+void Interpreter::prepare_eval_ctx(ASTNode *cond, PrecondNode *pre_cond) {
+	//the same traversal as CodegenZ3Visitor::prepare_eval_ctx
+	auto cb = [this](ASTNode *node) {
+		prepare_eval_ctx(node);
+		return true;
+	};
+	if (pre_cond) {
+		pre_cond->visitChildren(cb);
+	}
+	cond->visitChildren(cb);
+
+	z3_gen(visitor->get_z3_visitor(), cond, pre_cond);
+}
+
+void Interpreter::prepare_eval_ctx(ASTNode *node) {
+	if (auto ident = node_cast<IdentNode>(node)) {
+		if (!ident->symbol->is_input) {
+			ident->symbol->addr = get_storage(ident->symbol.get());
+		}
+	} else if (auto arr_lookup = node_cast<ArrLookupNode>(node)) {
+		if (!arr_lookup->ident->symbol->is_input) {
+			arr_lookup->current_ptr = get_address(arr_lookup);
+			return;
+		}
+
+		std::vector<int> idxs;
+		idxs.reserve(arr_lookup->idxs.size());
+		for (const auto &idx: arr_lookup->idxs) {
+			idxs.push_back(idx->eval(this).num);
+		}
+		arr_lookup->current_idxs = std::move(idxs);
+	} else if (auto prop_lookup = node_cast<PropertyLookupNode>(node)) {
+		auto sym = prop_lookup->ident->symbol;
+		if (!sym->is_input) {
+			sym->addr = get_storage(sym.get());
+		}
+	}
+}
+
+int Interpreter::get_sizeof(Type type) {
+	return type.get_sizeof();
+}
+
+InterpValue Interpreter::load(const uint8_t *addr, Type type) {
+	InterpValue val;
+	switch (type.getCurrentType()) {
+		case TypeKind::INT:
+			std::memcpy(&val.num, addr, sizeof(int32_t));
+			break;
+		case TypeKind::CHAR:
+		case TypeKind::BOOL:
+			val.num = *(const int8_t*)addr;
+			break;
+		default:
+			std::memcpy(&val.ptr, addr, sizeof(uint8_t*));
+			break;
+	}
+	return val;
+}
+
+void Interpreter::store(uint8_t *addr, Type type, InterpValue val) {
+	int8_t int8;
+	switch (type.getCurrentType()) {
+		case TypeKind::INT:
+			std::memcpy(addr, &val.num, sizeof(int32_t));
+			break;
+		case TypeKind::CHAR:
+		case TypeKind::BOOL:
+			int8 = (int8_t)val.num;
+			std::memcpy(addr, &int8, sizeof(int8));
+			break;
+		default:
+			std::memcpy(addr, &val.ptr, sizeof(uint8_t*));
+			break;
+	}
+}
+
+InterpValue Interpreter::convert_val_if_convertible(InterpValue val, Type src_t, Type dest_t) {
+	//chars are already sign extended, so only the truncation is left
+	if (dest_t != src_t && src_t.is_convertable_to(dest_t) &&
+		(dest_t == TypeKind::CHAR || dest_t == TypeKind::BOOL)) {
+		val.num = (int8_t)val.num;
+	}
+	return val;
+}
@@ -0,0 +1,95 @@
+//
+// Created by Anton on 17.10.2026.
+//
+
+#ifndef D_GEN_INTERPRETER_H
+#define D_GEN_INTERPRETER_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "ast.h"
+
+class CodegenVisitor;
+struct Runtime;
+
+//value of an expression: ints, chars and bools are in num (chars sign extended),
+//arrays and strings are pointers to the data
+struct InterpValue {
+	int32_t num = 0;
+	uint8_t *ptr = nullptr;
+};
+
+//tree walking interpreter of the program, it makes the same callbacks
+//(generators, z3_gen, gather_res) in the same order as the generated code,
+//so a test doesn't depend on which of them generated it.
+//locals are kept in the native layout, z3 reads them by the symbol's addr
+class Interpreter {
+public:
+	explicit Interpreter(FunctionNode *func, CodegenVisitor *visitor, Runtime *rt,
+						 bool coverage_guided, bool bounds_checks);
+
+	//generates one test
+	void run();
+
+	InterpValue eval(BodyNode *body);
+	InterpValue eval(BoolNode *node);
+	InterpValue eval(NumberNode *node);
+	InterpValue eval(StringNode *node);
+	InterpValue eval(CharNode *node);
+	InterpValue eval(BinOpNode *node);
+	InterpValue eval(IdentNode *node);
+	InterpValue eval(DefNode *node);
+	InterpValue eval(ReturnNode *node);
+	InterpValue eval(AsgNode *node);
+
+	InterpValue eval(ArrLookupNode *node);
+	InterpValue eval(PropertyLookupNode *node);
+	InterpValue eval(ArrCreateNode *node);
+
+	InterpValue eval(IfNode *node);
+	InterpValue eval(ForNode *node);
+	InterpValue eval(ContinueNode *node);
+	InterpValue eval(BreakNode *node);
+private:
+	//where the control goes after the current statement
+	enum class Flow {
+		NEXT,
+		BREAK,
+		CONTINUE,
+		RETURN
+	};
+
+	FunctionNode *func;
+	CodegenVisitor *visitor;
+	Runtime *rt;
+	bool coverage_guided;
+	bool bounds_checks;
+	Flow flow = Flow::NEXT;
+
+	//8 bytes per local (the same as its alloca), the nodes of the map are stable
+	std::unordered_map<Symbol*, uint64_t> locals;
+	//string literals with the arena header in front of the data
+	std::unordered_map<StringNode*, std::vector<uint64_t>> strings;
+	//header of the empty array, the value of not initialized arrays
+	uint64_t empty_arr[2] = {0, 0};
+
+	//the same limits as on the back-edges of the generated code
+	void back_edge();
+	//evaluates the condition of the if or the loop as the generated code:
+	//solves it and counts the hit of the edge when needed
+	bool eval_cond(ASTNode *cond, PrecondNode *pre_cond);
+	uint8_t *get_storage(Symbol *sym);
+	uint8_t *get_address(ASTNode *node);
+	//z3 reads the locals of the condition and the current indexes of input arrays
+	void prepare_eval_ctx(ASTNode *cond, PrecondNode *pre_cond);
+	void prepare_eval_ctx(ASTNode *node);
+
+	static int get_sizeof(Type type);
+	static InterpValue load(const uint8_t *addr, Type type);
+	static void store(uint8_t *addr, Type type, InterpValue val);
+	static InterpValue convert_val_if_convertible(InterpValue val, Type src_t, Type dest_t);
+};
+
+#endif //D_GEN_INTERPRETER_H
@@ -5,10 +5,19 @@
 #ifndef D_GEN_LLVMCTX_H
 #define D_GEN_LLVMCTX_H
 
+struct Runtime;
+class SlotTable;
+
 struct LLVMCtx {
 	llvm::LLVMContext *ctx;
 	llvm::Module *mod;
 	llvm::IRBuilder<> *builder;
+	//state of the worker passed to the runtime callbacks
+	Runtime *rt;
+	//host pointers used by the code, see Symbol::get_ptr
+	SlotTable *slots;
+	//llvm types of the context by Type::get_id, see Symbol::map_type_to_llvm_type
+	std::vector<llvm::Type*> *llvm_types;
 };
 
 #endif //D_GEN_LLVMCTX_H
@@ -0,0 +1,114 @@
+//
+// Created by Anton on 17.10.2026.
+//
+
+#include "ObjectCache.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Host.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/SHA1.h"
+#include "llvm/Support/raw_ostream.h"
+
+ObjectCache::ObjectCache(std::string dir): dir(std::move(dir)) {
+	llvm::sys::fs::create_directories(this->dir);
+}
+
+std::string ObjectCache::key(const std::string &source, const ProgramOptions &options) {
+	llvm::SHA1 hasher;
+	hasher.update(D_GEN_VERSION);
+	hasher.update("|");
+	hasher.update(LLVM_VERSION_STRING);
+	hasher.update("|");
+	hasher.update(llvm::sys::getProcessTriple());
+	hasher.update("|");
+	hasher.update(llvm::sys::getHostCPUName());
+	hasher.update("|");
+	//the same cpu can have some features disabled (e.g. in a vm), the jit targets them too
+	llvm::StringMap<bool> features;
+	if (llvm::sys::getHostCPUFeatures(features)) {
+		std::vector<std::string> enabled;
+		for (const auto &feature: features) {
+			if (feature.getValue()) {
+				enabled.push_back(feature.getKey().str());
+			}
+		}
+		std::sort(enabled.begin(), enabled.end());
+		for (const auto &feature: enabled) {
+			hasher.update(feature);
+			hasher.update(",");
+		}
+	}
+	hasher.update("|");
+	hasher.update(std::to_string((int)options.encoding));
+	hasher.update("|");
+	hasher.update(std::to_string((int)resolve_opt_level(options.opt_level, -1)));
+	hasher.update("|");
+	//the values of the limits are read at runtime
+	hasher.update(options.has_test_limits() ? "limits" : "");
+	hasher.update("|");
+	hasher.update(options.bounds_checks ? "bounds" : "");
+	hasher.update("|");
+	hasher.update(options.coverage_guided ? "coverage" : "");
+	hasher.update("|");
+	hasher.update(options.collect_stats ? "stats" : "");
+	hasher.update("|");
+	hasher.update(source);
+	return llvm::toHex(hasher.final(), true);
+}
+
+std::string ObjectCache::path(const std::string &key) const {
+	llvm::SmallString<256> res(dir);
+	llvm::sys::path::append(res, key + ".o");
+	return std::string(res.str());
+}
+
+bool ObjectCache::load(const std::string &key) {
+	auto buf = llvm::MemoryBuffer::getFile(path(key));
+	if (!buf) {
+		return false;
+	}
+	loaded_key = key;
+	loaded = std::move(*buf);
+	return true;
+}
+
+void ObjectCache::notifyObjectCompiled(const llvm::Module *M, llvm::MemoryBufferRef Obj) {
+	//other processes (or workers) can compile the same program at the same time,
+	//so the object is written to a unique file and renamed
+	int fd;
+	llvm::SmallString<256> tmp_path;
+	auto model = path(M->getModuleIdentifier()) + "-%%%%%%.tmp";
+	if (llvm::sys::fs::createUniqueFile(model, fd, tmp_path)) {
+		//the cache is an optimization only
+		return;
+	}
+	{
+		llvm::raw_fd_ostream out(fd, true);
+		out << Obj.getBuffer();
+		if (out.has_error()) {
+			out.clear_error();
+			llvm::sys::fs::remove(tmp_path);
+			return;
+		}
+	}
+	if (llvm::sys::fs::rename(tmp_path, path(M->getModuleIdentifier()))) {
+		llvm::sys::fs::remove(tmp_path);
+	}
+}
+
+std::unique_ptr<llvm::MemoryBuffer> ObjectCache::getObject(const llvm::Module *M) {
+	//only the loaded object, the module was optimized otherwise
+	if (!loaded || M->getModuleIdentifier() != loaded_key) {
+		return nullptr;
+	}
+	return std::move(loaded);
+}
@@ -0,0 +1,38 @@
+//
+// Created by Anton on 17.10.2026.
+//
+
+#ifndef D_GEN_OBJECTCACHE_H
+#define D_GEN_OBJECTCACHE_H
+
+#include <memory>
+#include <string>
+
+#include "llvm/ExecutionEngine/ObjectCache.h"
+
+#include "Options.h"
+
+//compiled objects stored in the directory, a file per program.
+//the module identifier is used as the key, see ObjectCache::key
+class ObjectCache: public llvm::ObjectCache {
+public:
+	explicit ObjectCache(std::string dir);
+
+	//hash of everything the object depends on:
+	//the source, the options, d_gen and llvm versions and the target
+	static std::string key(const std::string &source, const ProgramOptions &options);
+
+	//reads the object of the key, getObject returns it.
+	//the file is read once, so the module isn't compiled unoptimized if it's removed meanwhile
+	bool load(const std::string &key);
+
+	void notifyObjectCompiled(const llvm::Module *M, llvm::MemoryBufferRef Obj) override;
+	std::unique_ptr<llvm::MemoryBuffer> getObject(const llvm::Module *M) override;
+private:
+	std::string dir;
+	std::string loaded_key;
+	std::unique_ptr<llvm::MemoryBuffer> loaded;
+	std::string path(const std::string &key) const;
+};
+
+#endif //D_GEN_OBJECTCACHE_H
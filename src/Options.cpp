@@ -0,0 +1,27 @@
+//
+// Created by Anton on 17.10.2026.
+//
+
+#include "Options.h"
+
+//compilation at O2/O3 takes tens of milliseconds more than at O0,
+//it pays off only when the code runs for many tests
+#define O0_MAX_TESTS 256
+#define O2_MAX_TESTS 100000
+
+OptLevel resolve_opt_level(OptLevel level, int tests_num) {
+	if (level != OptLevel::AUTO) {
+		return level;
+	}
+	if (tests_num < 0) {
+		//not known, the program is probably reused
+		return OptLevel::O2;
+	}
+	if (tests_num <= O0_MAX_TESTS) {
+		return OptLevel::O0;
+	}
+	if (tests_num <= O2_MAX_TESTS) {
+		return OptLevel::O2;
+	}
+	return OptLevel::O3;
+}
@@ -0,0 +1,61 @@
+//
+// Created by Anton on 17.10.2026.
+//
+
+#include "Random.h"
+
+static uint64_t splitmix64(uint64_t &state) {
+	uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	return z ^ (z >> 31);
+}
+
+static inline uint64_t rotl(uint64_t x, int k) {
+	return (x << k) | (x >> (64 - k));
+}
+
+uint32_t Random::uniform(uint32_t bound) {
+	//Lemire's multiply and reject, no modulo bias
+	uint64_t m = (next_u64() >> 32) * bound;
+	auto low = (uint32_t)m;
+	if (low < bound) {
+		uint32_t threshold = -bound % bound;
+		while (low < threshold) {
+			m = (next_u64() >> 32) * bound;
+			low = (uint32_t)m;
+		}
+	}
+	return (uint32_t)(m >> 32);
+}
+
+unsigned int Random::next_uint() {
+	return (unsigned int)(next_u64() >> 32);
+}
+
+std::unique_ptr<Random> Random::create() {
+	return std::make_unique<XoshiroRandom>();
+}
+
+void XoshiroRandom::seed(uint64_t seed, uint64_t stream) {
+	uint64_t sm = seed;
+	sm = splitmix64(sm) ^ stream;
+	for (auto &word: s) {
+		word = splitmix64(sm);
+	}
+}
+
+uint64_t XoshiroRandom::next_u64() {
+	const uint64_t result = rotl(s[1] * 5, 7) * 9;
+	const uint64_t t = s[1] << 17;
+
+	s[2] ^= s[0];
+	s[3] ^= s[1];
+	s[1] ^= s[2];
+	s[0] ^= s[3];
+
+	s[2] ^= t;
+	s[3] = rotl(s[3], 45);
+
+	return result;
+}
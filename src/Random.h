@@ -0,0 +1,37 @@
+//
+// Created by Anton on 17.10.2026.
+//
+
+#ifndef D_GEN_RANDOM_H
+#define D_GEN_RANDOM_H
+
+#include <cstdint>
+#include <memory>
+
+//random engine of a worker, passed to every generator of the runtime
+//every test is generated from its own stream derived from (seed, test index)
+//so a test doesn't depend on the worker and the order it was generated in
+class Random {
+public:
+	virtual ~Random() = default;
+	//moves the engine to the beginning of the stream
+	virtual void seed(uint64_t seed, uint64_t stream) = 0;
+	virtual uint64_t next_u64() = 0;
+
+	//uniform value in [0, bound)
+	uint32_t uniform(uint32_t bound);
+	unsigned int next_uint();
+
+	static std::unique_ptr<Random> create();
+};
+
+//xoshiro256** seeded with splitmix64
+class XoshiroRandom: public Random {
+public:
+	void seed(uint64_t seed, uint64_t stream) override;
+	uint64_t next_u64() override;
+private:
+	uint64_t s[4] = {1, 2, 3, 4};
+};
+
+#endif //D_GEN_RANDOM_H
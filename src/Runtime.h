@@ -0,0 +1,130 @@
+//
+// Created by Anton on 17.10.2026.
+//
+
+#ifndef D_GEN_RUNTIME_H
+#define D_GEN_RUNTIME_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+
+#include "Arena.h"
+#include "Coverage.h"
+#include "Options.h"
+#include "Random.h"
+
+//time between the checks of the deadline on the back-edges, the number of back-edges
+//between the checks is adapted to it within [MIN, MAX] steps
+#define DEADLINE_CHECK_INTERVAL_NS 100000
+#define DEADLINE_CHECK_MIN_STEPS 16
+#define DEADLINE_CHECK_MAX_STEPS 65536
+
+//thrown out of the generated code when the test can't be completed,
+//the test is retried or dropped
+class TestAborted: public std::runtime_error {
+public:
+	enum Reason {
+		LOOP_BUDGET,
+		TIMEOUT,
+		OUT_OF_BOUNDS
+	};
+
+	Reason reason;
+
+	TestAborted(Reason reason, const std::string &msg): std::runtime_error(msg), reason(reason) {}
+};
+
+//limits of the current test. the back-edges of the loops decrement steps_left
+//and call check() when it drops below zero, so the clock is read rarely.
+//the solver checks the deadline itself, its queries are limited by the time left
+class TestLimits {
+public:
+	int64_t steps_left = INT64_MAX;
+
+	void start(const ProgramOptions &options) {
+		budget_left = options.loop_budget != 0 ? options.loop_budget : UINT64_MAX;
+		deadline_set = options.test_timeout_ms > 0;
+		if (deadline_set) {
+			last_check = clock::now();
+			deadline = last_check + std::chrono::milliseconds(options.test_timeout_ms);
+			check_steps = DEADLINE_CHECK_MIN_STEPS;
+		}
+		refill();
+	}
+
+	//throws TestAborted when the test is over its limits
+	void check() {
+		if (budget_left == 0) {
+			throw TestAborted(TestAborted::LOOP_BUDGET, "loop budget of the test is exhausted");
+		}
+		if (deadline_set) {
+			auto now = clock::now();
+			check_deadline(now);
+			//the steps since the last check took too long or too little
+			auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(now - last_check).count();
+			if (elapsed > DEADLINE_CHECK_INTERVAL_NS) {
+				check_steps = std::max<uint64_t>(check_steps / 2, DEADLINE_CHECK_MIN_STEPS);
+			} else if (elapsed < DEADLINE_CHECK_INTERVAL_NS / 2) {
+				check_steps = std::min<uint64_t>(check_steps * 2, DEADLINE_CHECK_MAX_STEPS);
+			}
+			last_check = now;
+		}
+		refill();
+		//the back-edge that called the check
+		steps_left--;
+	}
+
+	bool has_deadline() const {
+		return deadline_set;
+	}
+
+	//throws TestAborted if the deadline has passed
+	void check_deadline() {
+		if (deadline_set) {
+			check_deadline(clock::now());
+		}
+	}
+
+	//milliseconds to the deadline, at least 1 (has_deadline only)
+	unsigned ms_left() const {
+		auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - clock::now()).count();
+		return (unsigned)std::max<int64_t>(left, 1);
+	}
+private:
+	using clock = std::chrono::steady_clock;
+
+	//steps of the budget that aren't in steps_left yet
+	uint64_t budget_left = UINT64_MAX;
+	bool deadline_set = false;
+	clock::time_point deadline;
+	clock::time_point last_check;
+	//back-edges between the checks of the deadline
+	uint64_t check_steps = DEADLINE_CHECK_MIN_STEPS;
+
+	void check_deadline(clock::time_point now) {
+		if (now >= deadline) {
+			throw TestAborted(TestAborted::TIMEOUT, "test timed out");
+		}
+	}
+
+	void refill() {
+		uint64_t steps = std::min<uint64_t>(budget_left, deadline_set ? check_steps : INT64_MAX);
+		budget_left -= steps;
+		steps_left = (int64_t)steps;
+	}
+};
+
+//state of a worker that the generated code and the generators work with
+struct Runtime {
+	std::unique_ptr<Random> rng = Random::create();
+	//values allocated during the current test
+	Arena arena;
+	TestLimits limits;
+	//counted with ProgramOptions::coverage_guided or collect_stats only
+	Coverage coverage;
+};
+
+#endif //D_GEN_RUNTIME_H
@@ -15,15 +15,15 @@ void Semantics::eliminate_unreachable_code() {
 void Semantics::eliminate_unreachable_code_visit_body(BodyNode *body) {
 	for (int i = 0; i < body->stmts.size(); i++) {
 		auto stmt = body->stmts[i];
-		if (dynamic_cast<ContinueNode*>(stmt) ||
-		dynamic_cast<BreakNode*>(stmt) ||
-		dynamic_cast<ReturnNode*>(stmt)) {
+		if (node_cast<ContinueNode>(stmt) ||
+		node_cast<BreakNode>(stmt) ||
+		node_cast<ReturnNode>(stmt)) {
 			body->stmts.resize(i+1);
 			return;
 		}
-		if (auto loop = dynamic_cast<ForNode*>(stmt)) {
+		if (auto loop = node_cast<ForNode>(stmt)) {
 			eliminate_unreachable_code_visit_body(loop->body);
-		} else if (auto cond = dynamic_cast<IfNode*>(stmt)) {
+		} else if (auto cond = node_cast<IfNode>(stmt)) {
 			eliminate_unreachable_code_visit_body(cond->body);
 			if (cond->else_body) {
 				eliminate_unreachable_code_visit_body(cond->else_body);
@@ -38,21 +38,21 @@ void Semantics::connect_loops() {
 
 void Semantics::connect_loops_visit_body(BodyNode *body, ForNode *loop) {
 	for (auto stmt : body->stmts) {
-		if (auto cont = dynamic_cast<ContinueNode*>(stmt)) {
+		if (auto cont = node_cast<ContinueNode>(stmt)) {
 			if (!loop) {
 				throw BuildError(Err{cont->pos, "cannot match a continue node to a loop"});
 			}
 			cont->loop = loop;
 			return;
-		} else if (auto br = dynamic_cast<BreakNode*>(stmt)) {
+		} else if (auto br = node_cast<BreakNode>(stmt)) {
 			if (!loop) {
 				throw BuildError(Err{br->pos, "cannot match a break node to a loop"});
 			}
 			br->loop = loop;
 			return;
-		} else if (auto f_loop = dynamic_cast<ForNode*>(stmt)) {
+		} else if (auto f_loop = node_cast<ForNode>(stmt)) {
 			connect_loops_visit_body(f_loop->body, f_loop);
-		} else if (auto cond = dynamic_cast<IfNode*>(stmt)) {
+		} else if (auto cond = node_cast<IfNode>(stmt)) {
 			connect_loops_visit_body(cond->body, loop);
 			if (cond->else_body) {
 				connect_loops_visit_body(cond->else_body, loop);
@@ -70,27 +70,31 @@ std::vector<std::shared_ptr<Symbol>> Semantics::type_ast() {
 		s_table->add_symbol(arg->name, in_sym);
 	}
 
-	func->body->visitChildren(&type_visitor, s_table);
+	type_visit_body(func->body, s_table);
 
 	return std::move(inputs);
 }
 
-bool Semantics::type_visitor(ASTNode *node, std::any &ctx) {
-	auto s_table = std::any_cast<std::shared_ptr<SymbolTable>>(ctx);
+void Semantics::type_visit_body(BodyNode *body, const std::shared_ptr<SymbolTable> &s_table) {
+	body->visitChildren([&](ASTNode *node) {
+		return type_visitor(node, s_table);
+	});
+}
 
-	if (auto def = dynamic_cast<DefNode*>(node)) {
+bool Semantics::type_visitor(ASTNode *node, const std::shared_ptr<SymbolTable> &s_table) {
+	if (auto def = node_cast<DefNode>(node)) {
 		auto sym = Symbol::create_symbol(def->pos, def->type, def->name);
 		def->sym = sym;
 		s_table->add_symbol(def->name, sym);
-	} else if (auto ident = dynamic_cast<IdentNode*>(node)) {
+	} else if (auto ident = node_cast<IdentNode>(node)) {
 		auto symbol = s_table->find_symbol(ident->name);
 		if (!symbol) {
 			throw BuildError(Err{ident->pos, "undefined symbol " + ident->name});
 		}
 
 		ident->symbol = symbol;
-	} else if (auto body = dynamic_cast<BodyNode*>(node)) {
-		body->visitChildren(&type_visitor, std::make_shared<SymbolTable>(s_table));
+	} else if (auto body = node_cast<BodyNode>(node)) {
+		type_visit_body(body, std::make_shared<SymbolTable>(s_table));
 		return false;
 	}
 
@@ -98,32 +102,33 @@ bool Semantics::type_visitor(ASTNode *node, std::any &ctx) {
 }
 
 void Semantics::type_check() {
-	func->visitChildren(&type_check_visitor, func);
+	func->visitChildren([this](ASTNode *node) {
+		return type_check_visitor(node, func);
+	});
 }
 
-bool Semantics::type_check_visitor(ASTNode *node, std::any &ctx) {
-	auto func = std::any_cast<FunctionNode*>(ctx);
-	if (auto pre_cond = dynamic_cast<PrecondNode*>(node)) {
+bool Semantics::type_check_visitor(ASTNode *node, FunctionNode *func) {
+	if (auto pre_cond = node_cast<PrecondNode>(node)) {
 		type_check_precondition(pre_cond);
-	} else if (auto ret = dynamic_cast<ReturnNode*>(node)) {
+	} else if (auto ret = node_cast<ReturnNode>(node)) {
 		auto t = ret->expr->get_type();
 		if (t != func->ret_type) {
 			throw BuildError(Err{ret->pos, "ret type is different, expected " +
 				func->ret_type.to_string() + ", got " +
 				t.to_string()});
 		}
-	} else if (auto asg = dynamic_cast<AsgNode*>(node)) {
-		if (auto ident = dynamic_cast<IdentNode*>(asg->lhs)) {
+	} else if (auto asg = node_cast<AsgNode>(node)) {
+		if (auto ident = node_cast<IdentNode>(asg->lhs)) {
 			if (ident->symbol->is_input) {
 				throw BuildError(Err{ident->pos, "can not assign to input variable"});
 			}
-		} else if (auto arr_lookup = dynamic_cast<ArrLookupNode*>(asg->lhs)) {
+		} else if (auto arr_lookup = node_cast<ArrLookupNode>(asg->lhs)) {
 			if (arr_lookup->ident->symbol->is_input) {
 				throw BuildError(Err{arr_lookup->pos, "can not assign to input variable"});
 			}
 		}
 		type_check_asg(asg);
-	} else if (auto def = dynamic_cast<DefNode*>(node)) {
+	} else if (auto def = node_cast<DefNode>(node)) {
 		if (!def->rhs) {
 			return false;
 		}
@@ -134,21 +139,21 @@ bool Semantics::type_check_visitor(ASTNode *node, std::any &ctx) {
 										   def->type.to_string() + " and " +
 										   t.to_string()});
 		}
-	} else if (auto loop = dynamic_cast<ForNode*>(node)) {
+	} else if (auto loop = node_cast<ForNode>(node)) {
 		auto cond_t = loop->cond->get_type();
 		if (cond_t != TypeKind::BOOL) {
 			throw BuildError(Err{loop->pos,
 								 "loop stop condition must be evaluated to bool, got " +
 								 cond_t.to_string()});
 		}
-	} else if (auto if_node = dynamic_cast<IfNode*>(node)) {
+	} else if (auto if_node = node_cast<IfNode>(node)) {
 		auto cond_t = if_node->cond->get_type();
 		if (cond_t != TypeKind::BOOL) {
 			throw BuildError(Err{if_node->pos,
 								 "if operator condition must be evaluated to bool, got " +
 								 cond_t.to_string()});
 		}
-	} else if (auto arr_lookup = dynamic_cast<ArrLookupNode*>(node)) {
+	} else if (auto arr_lookup = node_cast<ArrLookupNode>(node)) {
 		for (auto idx: arr_lookup->idxs) {
 			if (idx->get_type() != TypeKind::INT) {
 				throw BuildError(Err{idx->pos, "index should have int type"});
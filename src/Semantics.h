@@ -8,6 +8,8 @@
 #include "ast.h"
 #include "Symbol.h"
 
+class SymbolTable;
+
 class Semantics {
 public:
 	std::vector<Symbol*> symbols;
@@ -21,8 +23,9 @@ private:
 	FunctionNode *func;
 	void eliminate_unreachable_code_visit_body(BodyNode *body);
 	void connect_loops_visit_body(BodyNode *body, ForNode *loop);
-	static bool type_visitor(ASTNode *node, std::any &ctx);
-	static bool type_check_visitor(ASTNode *node, std::any &ctx);
+	static void type_visit_body(BodyNode *body, const std::shared_ptr<SymbolTable> &s_table);
+	static bool type_visitor(ASTNode *node, const std::shared_ptr<SymbolTable> &s_table);
+	static bool type_check_visitor(ASTNode *node, FunctionNode *func);
 	static void type_check_precondition(PrecondNode *pre_cond);
 	static void type_check_asg(AsgNode *asg_node);
 };
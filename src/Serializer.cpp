@@ -0,0 +1,269 @@
+//
+// Created by Anton on 17.10.2026.
+//
+
+#include "Serializer.h"
+
+#include <cstring>
+#include <stdexcept>
+
+#include "Arena.h"
+#include "Symbol.h"
+
+Serializer::Serializer(std::vector<Column> columns): columns(std::move(columns)) {}
+
+std::unique_ptr<Serializer> Serializer::create(OutputFormat format, std::vector<Column> columns) {
+	switch (format) {
+		case OutputFormat::JSON:
+			return std::make_unique<JsonSerializer>(std::move(columns));
+		case OutputFormat::BINARY:
+			return std::make_unique<BinarySerializer>(std::move(columns));
+		case OutputFormat::COLUMNAR:
+			return std::make_unique<ColumnarSerializer>(std::move(columns));
+	}
+	throw std::runtime_error("unknown output format");
+}
+
+void Serializer::write_block(std::string &out, const std::vector<std::vector<std::string>> &tests) {
+	for (const auto &test: tests) {
+		write_test(out, test);
+	}
+}
+
+void Serializer::write_scalars(std::string &cell, TypeKind kind, const uint8_t *data, uint32_t size) {
+	switch (kind) {
+		case TypeKind::INT:
+			for (uint32_t i = 0; i < size; i++) {
+				int32_t val;
+				std::memcpy(&val, data + i*sizeof(val), sizeof(val));
+				if (i != 0) {
+					array_separator(cell);
+				}
+				write_int(cell, val);
+			}
+			break;
+		case TypeKind::CHAR:
+			for (uint32_t i = 0; i < size; i++) {
+				if (i != 0) {
+					array_separator(cell);
+				}
+				write_char(cell, (int8_t)data[i]);
+			}
+			break;
+		case TypeKind::BOOL:
+			for (uint32_t i = 0; i < size; i++) {
+				if (i != 0) {
+					array_separator(cell);
+				}
+				write_bool(cell, data[i] != 0);
+			}
+			break;
+		default:
+			throw std::runtime_error("write_scalars on not scalar type");
+	}
+}
+
+void JsonSerializer::write_int(std::string &cell, int32_t val) {
+	cell += std::to_string(val);
+}
+
+void JsonSerializer::write_char(std::string &cell, int8_t val) {
+	cell += std::to_string((char)val);
+}
+
+void JsonSerializer::write_bool(std::string &cell, bool val) {
+	cell += val ? "true" : "false";
+}
+
+void JsonSerializer::write_string(std::string &cell, const char *data, uint32_t size) {
+	//TODO: escape json
+	cell += '"';
+	cell.append(data, size);
+	cell += '"';
+}
+
+void JsonSerializer::begin_array(std::string &cell, uint32_t) {
+	cell += '[';
+}
+
+void JsonSerializer::array_separator(std::string &cell) {
+	cell += ',';
+}
+
+void JsonSerializer::end_array(std::string &cell) {
+	cell += ']';
+}
+
+std::string JsonSerializer::header() {
+	return "{\n\t\"tests\": [\n";
+}
+
+void JsonSerializer::write_test(std::string &out, const std::vector<std::string> &cells) {
+	out += "{\n";
+	for (int i = 0; i < columns.size(); i++) {
+		out += "\t\t\"" + columns[i].name + "\": ";
+		out += cells[i];
+		if (i + 1 != columns.size()) {
+			out += ',';
+		}
+		out += '\n';
+	}
+	out += "\t}";
+}
+
+void JsonSerializer::write_block(std::string &out, const std::vector<std::vector<std::string>> &tests) {
+	for (int i = 0; i < tests.size(); i++) {
+		out += i == 0 ? "\t" : ",\n\t";
+		write_test(out, tests[i]);
+	}
+}
+
+std::string JsonSerializer::block_separator() {
+	return ",\n";
+}
+
+std::string JsonSerializer::footer(bool has_tests) {
+	return has_tests ? "\n\t]\n}" : "\t]\n}";
+}
+
+void BinarySerializer::write_u32(std::string &out, uint32_t val) {
+	char bytes[sizeof(val)];
+	std::memcpy(bytes, &val, sizeof(val));
+	out.append(bytes, sizeof(val));
+}
+
+void BinarySerializer::write_int(std::string &cell, int32_t val) {
+	write_u32(cell, (uint32_t)val);
+}
+
+void BinarySerializer::write_char(std::string &cell, int8_t val) {
+	cell += (char)val;
+}
+
+void BinarySerializer::write_bool(std::string &cell, bool val) {
+	cell += (char)val;
+}
+
+void BinarySerializer::write_string(std::string &cell, const char *data, uint32_t size) {
+	write_u32(cell, size);
+	cell.append(data, size);
+}
+
+void BinarySerializer::begin_array(std::string &cell, uint32_t size) {
+	write_u32(cell, size);
+}
+
+void BinarySerializer::write_scalars(std::string &cell, TypeKind kind, const uint8_t *data, uint32_t size) {
+	auto elem_size = kind == TypeKind::INT ? sizeof(int32_t) : sizeof(uint8_t);
+	cell.append((const char*)data, size*elem_size);
+}
+
+std::string BinarySerializer::columns_header(const char *magic) {
+	std::string out = magic;
+	write_u32(out, columns.size());
+	for (auto &col: columns) {
+		write_u32(out, col.name.size());
+		out += col.name;
+		auto type = col.type.to_string();
+		write_u32(out, type.size());
+		out += type;
+	}
+	return out;
+}
+
+std::string BinarySerializer::header() {
+	return columns_header("DGENBIN1");
+}
+
+void BinarySerializer::write_test(std::string &out, const std::vector<std::string> &cells) {
+	uint32_t size = 0;
+	for (const auto &cell: cells) {
+		size += cell.size();
+	}
+	write_u32(out, size);
+	for (const auto &cell: cells) {
+		out += cell;
+	}
+}
+
+std::string BinarySerializer::footer(bool) {
+	return "";
+}
+
+std::string ColumnarSerializer::header() {
+	return columns_header("DGENCOL1");
+}
+
+void ColumnarSerializer::write_block(std::string &out, const std::vector<std::vector<std::string>> &tests) {
+	write_u32(out, tests.size());
+	for (int col = 0; col < columns.size(); col++) {
+		uint32_t size = 0;
+		for (const auto &test: tests) {
+			size += test[col].size();
+		}
+		write_u32(out, size);
+
+		uint32_t offset = 0;
+		for (const auto &test: tests) {
+			write_u32(out, offset);
+			offset += test[col].size();
+		}
+		for (const auto &test: tests) {
+			out += test[col];
+		}
+	}
+}
+
+std::string ColumnarSerializer::footer(bool) {
+	std::string out;
+	write_u32(out, 0);
+	return out;
+}
+
+ValuePlan::ValuePlan(Type type): kind(type.getCurrentType()) {
+	if (kind == TypeKind::ARR) {
+		elem_size = type.dropType().get_sizeof();
+		elem = std::make_unique<ValuePlan>(type.dropType());
+	}
+}
+
+void ValuePlan::write(Serializer &s, std::string &cell, const uint8_t *val) const {
+	const uint8_t *ptr;
+	uint32_t size;
+
+	switch (kind) {
+		case TypeKind::INT:
+			int32_t num;
+			std::memcpy(&num, val, sizeof(num));
+			s.write_int(cell, num);
+			break;
+		case TypeKind::CHAR:
+			s.write_char(cell, *(const int8_t*)val);
+			break;
+		case TypeKind::BOOL:
+			s.write_bool(cell, *val != 0);
+			break;
+		case TypeKind::STRING:
+			ptr = *(uint8_t* const*)val;
+			s.write_string(cell, (const char*)ptr, Arena::get_len(ptr));
+			break;
+		case TypeKind::ARR:
+			ptr = *(uint8_t* const*)val;
+			size = Arena::get_len(ptr);
+			s.begin_array(cell, size);
+			if (elem->kind == TypeKind::INT || elem->kind == TypeKind::CHAR || elem->kind == TypeKind::BOOL) {
+				s.write_scalars(cell, elem->kind, ptr, size);
+			} else {
+				for (uint32_t i = 0; i < size; i++) {
+					if (i != 0) {
+						s.array_separator(cell);
+					}
+					elem->write(s, cell, ptr + i*elem_size);
+				}
+			}
+			s.end_array(cell);
+			break;
+		default:
+			break;
+	}
+}
@@ -0,0 +1,128 @@
+//
+// Created by Anton on 17.10.2026.
+//
+
+#ifndef D_GEN_SERIALIZER_H
+#define D_GEN_SERIALIZER_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "type.h"
+#include "Options.h"
+
+//encodes the values of the tests and assembles the tests into the output.
+//every input and the return value are separate cells of a test,
+//the cells are filled by write_* calls
+class Serializer {
+public:
+	struct Column {
+		std::string name;
+		Type type;
+	};
+
+	explicit Serializer(std::vector<Column> columns);
+	virtual ~Serializer() = default;
+
+	static std::unique_ptr<Serializer> create(OutputFormat format, std::vector<Column> columns);
+
+	virtual void write_int(std::string &cell, int32_t val) = 0;
+	virtual void write_char(std::string &cell, int8_t val) = 0;
+	virtual void write_bool(std::string &cell, bool val) = 0;
+	virtual void write_string(std::string &cell, const char *data, uint32_t size) = 0;
+	//elements are written between begin_array and end_array,
+	//separated with array_separator
+	virtual void begin_array(std::string &cell, uint32_t size) = 0;
+	virtual void array_separator(std::string &cell) {}
+	virtual void end_array(std::string &cell) {}
+	//elements of an array of scalars (without begin and end), data points to the native values
+	virtual void write_scalars(std::string &cell, TypeKind kind, const uint8_t *data, uint32_t size);
+
+	//everything before the first block of tests
+	virtual std::string header() = 0;
+	virtual void write_test(std::string &out, const std::vector<std::string> &cells) = 0;
+	//blocks are written independently, not empty ones are joined with block_separator
+	virtual void write_block(std::string &out, const std::vector<std::vector<std::string>> &tests);
+	virtual std::string block_separator() {
+		return "";
+	}
+	virtual std::string footer(bool has_tests) = 0;
+protected:
+	std::vector<Column> columns;
+};
+
+//the json document {"tests": [{"input": value, ..., "func": result}, ...]}
+class JsonSerializer: public Serializer {
+public:
+	using Serializer::Serializer;
+
+	void write_int(std::string &cell, int32_t val) override;
+	void write_char(std::string &cell, int8_t val) override;
+	void write_bool(std::string &cell, bool val) override;
+	void write_string(std::string &cell, const char *data, uint32_t size) override;
+	void begin_array(std::string &cell, uint32_t size) override;
+	void array_separator(std::string &cell) override;
+	void end_array(std::string &cell) override;
+
+	std::string header() override;
+	void write_test(std::string &out, const std::vector<std::string> &cells) override;
+	void write_block(std::string &out, const std::vector<std::vector<std::string>> &tests) override;
+	std::string block_separator() override;
+	std::string footer(bool has_tests) override;
+};
+
+//native little-endian values: int - 4 bytes, char and bool - 1 byte,
+//arrays and strings - 4 bytes length followed by the elements.
+//the header is "DGENBIN1", the number of columns and every column as
+//length prefixed name and type, then every test is prefixed with its size in bytes
+class BinarySerializer: public Serializer {
+public:
+	using Serializer::Serializer;
+
+	void write_int(std::string &cell, int32_t val) override;
+	void write_char(std::string &cell, int8_t val) override;
+	void write_bool(std::string &cell, bool val) override;
+	void write_string(std::string &cell, const char *data, uint32_t size) override;
+	void begin_array(std::string &cell, uint32_t size) override;
+	//native values are already in the binary format
+	void write_scalars(std::string &cell, TypeKind kind, const uint8_t *data, uint32_t size) override;
+
+	std::string header() override;
+	void write_test(std::string &out, const std::vector<std::string> &cells) override;
+	std::string footer(bool has_tests) override;
+protected:
+	std::string columns_header(const char *magic);
+	static void write_u32(std::string &out, uint32_t val);
+};
+
+//values are encoded as in the binary format, but every block of tests is a row group
+//that keeps the values of a column together:
+//number of rows, then for every column the size of its data,
+//offsets of the rows inside the data and the data.
+//the header starts with "DGENCOL1", zero rows mark the end
+class ColumnarSerializer: public BinarySerializer {
+public:
+	using BinarySerializer::BinarySerializer;
+
+	std::string header() override;
+	void write_block(std::string &out, const std::vector<std::vector<std::string>> &tests) override;
+	std::string footer(bool has_tests) override;
+};
+
+//serialization of a native value of the statically known type (the result of the function).
+//built once per program, so writing a value doesn't look at the Type
+//and arrays of scalars are written with one call
+class ValuePlan {
+public:
+	explicit ValuePlan(Type type);
+	void write(Serializer &s, std::string &cell, const uint8_t *val) const;
+private:
+	TypeKind kind;
+	//arrays only
+	int elem_size = 0;
+	std::unique_ptr<ValuePlan> elem;
+};
+
+#endif //D_GEN_SERIALIZER_H
@@ -0,0 +1,67 @@
+//
+// Created by Anton on 17.10.2026.
+//
+
+#include "Sink.h"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <unistd.h>
+
+OStreamSink::OStreamSink(std::ostream &out): out(out) {}
+
+void OStreamSink::write(const char *data, size_t size) {
+	out.write(data, (std::streamsize)size);
+	if (!out) {
+		throw std::runtime_error("can't write tests to the stream");
+	}
+}
+
+void OStreamSink::flush() {
+	out.flush();
+}
+
+FdSink::FdSink(int fd, size_t buf_size): fd(fd), buf(buf_size) {}
+
+FdSink::~FdSink() {
+	try {
+		flush();
+	} catch (...) {
+		//nowhere to report the error
+	}
+}
+
+void FdSink::write(const char *data, size_t size) {
+	if (used + size > buf.size()) {
+		flush();
+	}
+	//big chunks go around the buffer
+	if (size >= buf.size()) {
+		write_all(data, size);
+		return;
+	}
+	std::memcpy(buf.data() + used, data, size);
+	used += size;
+}
+
+void FdSink::flush() {
+	auto size = used;
+	used = 0;
+	write_all(buf.data(), size);
+}
+
+void FdSink::write_all(const char *data, size_t size) {
+	while (size > 0) {
+		auto written = ::write(fd, data, size);
+		if (written < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			throw std::runtime_error(std::string("can't write tests: ") + std::strerror(errno));
+		}
+		data += written;
+		size -= written;
+	}
+}
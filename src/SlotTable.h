@@ -0,0 +1,39 @@
+//
+// Created by Anton on 17.10.2026.
+//
+
+#ifndef D_GEN_SLOTTABLE_H
+#define D_GEN_SLOTTABLE_H
+
+#include <unordered_map>
+#include <vector>
+
+//host objects (symbols, nodes, runtime) used by the generated code.
+//the code gets the table as the argument of d_gen_func and loads the pointers by index,
+//so it doesn't depend on the addresses of the objects and can be cached.
+//codegen registers the objects in the same order for the same program
+class SlotTable {
+public:
+	int get_slot(void *ptr) {
+		auto it = idxs.find(ptr);
+		if (it != idxs.end()) {
+			return it->second;
+		}
+		slots.push_back(ptr);
+		idxs[ptr] = (int)slots.size() - 1;
+		return (int)slots.size() - 1;
+	}
+
+	void **data() {
+		return slots.data();
+	}
+
+	size_t size() const {
+		return slots.size();
+	}
+private:
+	std::vector<void*> slots;
+	std::unordered_map<void*, int> idxs;
+};
+
+#endif //D_GEN_SLOTTABLE_H
@@ -3,34 +3,34 @@
 //
 
 #include "Symbol.h"
+#include "Serializer.h"
+#include "SlotTable.h"
 #include "utils/assert.h"
 
-extern "C" uint8_t *arr_rand_gen(ArraySym *arr);
-extern "C" int8_t bool_rand_gen(BoolSym *sym);
-extern "C" int32_t num_rand_gen(NumberSym *sym);
-extern "C" int8_t char_rand_gen(CharSym *sym);
+extern "C" uint8_t *arr_rand_gen(ArraySym *arr, Runtime *rt);
+extern "C" int8_t bool_rand_gen(BoolSym *sym, Runtime *rt);
+extern "C" int32_t num_rand_gen(NumberSym *sym, Runtime *rt);
+extern "C" int8_t char_rand_gen(CharSym *sym, Runtime *rt);
 
-static void fill_dest(std::shared_ptr<Symbol> sym, uint8_t *dest) {
+static void fill_dest(std::shared_ptr<Symbol> sym, uint8_t *dest, Runtime *rt) {
 	auto pointed_sizeof = sym->get_sizeof();
 	if (auto num = std::dynamic_pointer_cast<NumberSym>(sym)) {
-		auto v = num_rand_gen(num.get());
+		auto v = num_rand_gen(num.get(), rt);
 		memcpy(dest, &v, pointed_sizeof);
 	} else if (auto bool_v = std::dynamic_pointer_cast<BoolSym>(sym)) {
-		auto v = bool_rand_gen(bool_v.get());
+		auto v = bool_rand_gen(bool_v.get(), rt);
 		memcpy(dest, &v, pointed_sizeof);
 	} else if (auto char_v = std::dynamic_pointer_cast<CharSym>(sym)) {
-		auto v = char_rand_gen(char_v.get());
+		auto v = char_rand_gen(char_v.get(), rt);
 		memcpy(dest, &v, pointed_sizeof);
 	} else if (auto arr_v = std::dynamic_pointer_cast<ArraySym>(sym)) {
-		auto v = arr_rand_gen(arr_v.get());
+		auto v = arr_rand_gen(arr_v.get(), rt);
 		memcpy(dest, &v, pointed_sizeof);
 	} else {
 		ASSERT(false, "unexpected type when constructing arr");
 	}
 }
 
-std::unordered_map<uint8_t*, Symbol::alloc_data> Symbol::allocated_vals;
-
 Symbol::Symbol(Position pos, Type type, std::string name, bool is_input):
 	pos(pos), type(type), name(std::move(name)), is_input(is_input) {}
 
@@ -39,8 +39,14 @@ llvm::Value *Symbol::code_gen(LLVMCtx /*ctx*/) {
 }
 
 llvm::Value *Symbol::get_ptr(void *ptr, LLVMCtx ctx) {
-	auto ptr_int = ctx.builder->getInt64((uint64_t)ptr);
-	return llvm::ConstantExpr::getIntToPtr(ptr_int, ctx.builder->getInt8PtrTy());
+	//the pointer is loaded from the slot table (the argument of d_gen_func),
+	//the table doesn't change while the function runs
+	auto &b = *ctx.builder;
+	auto slots = b.GetInsertBlock()->getParent()->getArg(0);
+	auto slot = b.CreateConstInBoundsGEP1_64(b.getInt8PtrTy(), slots, ctx.slots->get_slot(ptr));
+	auto load = b.CreateLoad(b.getInt8PtrTy(), slot);
+	load->setMetadata(llvm::LLVMContext::MD_invariant_load, llvm::MDNode::get(*ctx.ctx, {}));
+	return load;
 }
 
 std::shared_ptr<Symbol> Symbol::create_symbol(Position pos, Type type, std::string name, bool is_input) {
@@ -70,9 +76,13 @@ llvm::AllocaInst *Symbol::create_alloca(LLVMCtx ctx) {
 }
 
 llvm::Type *Symbol::map_type_to_llvm_type(Type type, LLVMCtx ctx) {
+	auto &cache = *ctx.llvm_types;
+	if (type.get_id() < cache.size() && cache[type.get_id()]) {
+		return cache[type.get_id()];
+	}
+
 	llvm::Type *llvm_t = nullptr;
-	auto scalar_t = type.types->at(type.types->size()-1);
-	switch (scalar_t) {
+	switch (type.get_scalar_kind()) {
 		case TypeKind::INT:
 			llvm_t = llvm::IntegerType::getInt32Ty(*ctx.ctx);
 			break;
@@ -91,6 +101,10 @@ llvm::Type *Symbol::map_type_to_llvm_type(Type type, LLVMCtx ctx) {
 		llvm_t = llvm_t->getPointerTo();
 	}
 
+	if (type.get_id() >= cache.size()) {
+		cache.resize(type.get_id() + 1);
+	}
+	cache[type.get_id()] = llvm_t;
 	return llvm_t;
 }
 
@@ -98,11 +112,9 @@ int Symbol::get_sizeof() {
 	return 0;
 }
 
-std::string Symbol::serialize() {
-	return "";
-}
+void Symbol::serialize(Runtime &, Serializer &, std::string &) {}
 
-z3::expr Symbol::get_expr(z3::context &ctx) {
+z3::expr Symbol::get_expr(z3::context &ctx, Z3Encoding) {
 	throw std::runtime_error("get expr on invalid expr");
 }
 
@@ -112,9 +124,9 @@ bool Symbol::has_val() {
 
 void Symbol::fill_val(z3::expr &) {}
 
-extern "C" int32_t num_rand_gen(NumberSym *sym) {
+extern "C" int32_t num_rand_gen(NumberSym *sym, Runtime *rt) {
 	if (!sym->num.has_value()) {
-		sym->num = std::rand() % 200;
+		sym->num = (int)rt->rng->uniform(200);
 	}
 	return *sym->num;
 }
@@ -122,11 +134,12 @@ extern "C" int32_t num_rand_gen(NumberSym *sym) {
 llvm::Value *NumberSym::code_gen(LLVMCtx ctx) {
 	auto cb = ctx.mod->getOrInsertFunction("num_rand_gen", get_cb_func_type(ctx.ctx));
 	auto ptr = Symbol::get_ptr(this, ctx);
-	return ctx.builder->CreateCall(cb, {ptr});
+	return ctx.builder->CreateCall(cb, {ptr, Symbol::get_ptr(ctx.rt, ctx)});
 }
 
 llvm::FunctionType *NumberSym::get_cb_func_type(llvm::LLVMContext *ctx) {
-	return llvm::FunctionType::get(llvm::Type::getInt32Ty(*ctx), {llvm::Type::getInt8PtrTy(*ctx)}, false);
+	return llvm::FunctionType::get(llvm::Type::getInt32Ty(*ctx), {llvm::Type::getInt8PtrTy(*ctx),
+																 llvm::Type::getInt8PtrTy(*ctx)}, false);
 }
 
 NumberSym::NumberSym(Position pos, Type type, std::string name, bool is_input): Symbol(pos, type, name, is_input) {}
@@ -135,15 +148,22 @@ int NumberSym::get_sizeof() {
 	return sizeof(uint32_t);
 }
 
-std::string NumberSym::serialize() {
-	return std::to_string(num_rand_gen(this));
+void NumberSym::serialize(Runtime &rt, Serializer &s, std::string &cell) {
+	s.write_int(cell, num_rand_gen(this, &rt));
 }
 
 bool NumberSym::has_val() {
 	return num.has_value();
 }
 
-z3::expr NumberSym::get_expr(z3::context &ctx) {
+z3::expr NumberSym::get_expr(z3::context &ctx, Z3Encoding encoding) {
+	if (encoding == Z3Encoding::BIT_VECTOR) {
+		if (num.has_value()) {
+			return ctx.bv_val(*num, 32);
+		}
+		return ctx.bv_const(name.c_str(), 32);
+	}
+
 	if (num.has_value()) {
 		return ctx.int_val(*num);
 	}
@@ -151,6 +171,11 @@ z3::expr NumberSym::get_expr(z3::context &ctx) {
 }
 
 void NumberSym::fill_val(z3::expr &expr) {
+	if (expr.is_bv()) {
+		//bit vector numerals are unsigned
+		num = (int32_t)expr.get_numeral_uint64();
+		return;
+	}
 	num = expr.get_numeral_int64();
 }
 
@@ -160,27 +185,30 @@ void NumberSym::reset_val() {
 
 ArraySym::ArraySym(Position pos, Type type, std::string name, bool is_input): Symbol(pos, type, name, is_input) {}
 
-extern "C" void get_val_arr(ArraySym *arr, int *idxs, int len, uint8_t *dest) {
+extern "C" void get_val_arr(ArraySym *arr, int *idxs, int len, uint8_t *dest, Runtime *rt) {
 	std::vector<int> idxs_vec;
 	idxs_vec.reserve(len);
 	for (int i = 0; i < len; i++) {
 		idxs_vec.push_back(idxs[i]);
 	}
 
-	auto sym = ArraySym::get_symbol_by_idxs(arr, idxs_vec);
-	fill_dest(sym, dest);
-}
+	auto sym = ArraySym::get_symbol_by_idxs(arr, idxs_vec, *rt->rng);
+	fill_dest(sym, dest, rt);
 
-extern "C" uint8_t *arr_rand_gen(ArraySym *arr) {
-	int size = arr->get_size();
-	int pointed_sizeof = arr->get_pointed_type_elem()->get_sizeof();
-	auto *data = static_cast<uint8_t *>(malloc(size * pointed_sizeof));
+	if (len == 1 && arr->is_native()) {
+		arr->materialize(*rt);
+		arr->set_native(idxs[0], dest);
+	}
+}
 
-	Symbol::allocated_vals[data] = {true, (uint32_t)size};
+extern "C" uint8_t *arr_rand_gen(ArraySym *arr, Runtime *rt) {
+	int size = arr->get_size(*rt->rng);
+	int pointed_sizeof = arr->type.dropType().get_sizeof();
+	auto *data = rt->arena.alloc_arr(size, pointed_sizeof);
 
 	for (int i = 0; i < arr->arr.size(); i++) {
 		auto val = arr->arr[i];
-		fill_dest(val, data + i * pointed_sizeof);
+		fill_dest(val, data + i * pointed_sizeof, rt);
 	}
 
 	return data;
@@ -191,17 +219,18 @@ llvm::Value *ArraySym::code_gen(LLVMCtx ctx) {
 	auto ret_type = map_type_to_llvm_type(type, ctx);
 	auto cb = ctx.mod->getOrInsertFunction("arr_rand_gen", get_cb_func_type(ret_type, ctx.ctx));
 	auto ptr = Symbol::get_ptr(this, ctx);
-	return ctx.builder->CreateCall(cb, {ptr});
+	return ctx.builder->CreateCall(cb, {ptr, Symbol::get_ptr(ctx.rt, ctx)});
 }
 
 llvm::FunctionType *ArraySym::get_cb_func_type(llvm::Type *ret_type, llvm::LLVMContext *ctx) {
-	return llvm::FunctionType::get(ret_type, {llvm::Type::getInt8PtrTy(*ctx)}, false);
+	return llvm::FunctionType::get(ret_type, {llvm::Type::getInt8PtrTy(*ctx),
+											  llvm::Type::getInt8PtrTy(*ctx)}, false);
 }
 
-int ArraySym::get_size() {
+int ArraySym::get_size(Random &rng) {
 	if (!inited_size.has_value()) {
-		//TODO: change modulo
-		inited_size = std::abs(std::rand() % 10);
+		//TODO: change bound
+		inited_size = (int)rng.uniform(ARR_LEN_BOUND);
 		init_arr(*inited_size);
 	}
 	return *inited_size;
@@ -216,7 +245,86 @@ int ArraySym::get_sizeof() {
 	return sizeof(uint8_t*);
 }
 
+bool ArraySym::is_native() {
+	return type.dropType().is_scalar();
+}
+
+void ArraySym::materialize(Runtime &rt) {
+	if (native.data || !is_native()) {
+		return;
+	}
+
+	auto size = get_size(*rt.rng);
+	native.data = rt.arena.alloc_arr(size, type.dropType().get_sizeof());
+	auto words = (size + 63) / 64;
+	native.valid = reinterpret_cast<uint64_t*>(rt.arena.alloc_arr(words, sizeof(uint64_t)));
+	memset(native.valid, 0, words * sizeof(uint64_t));
+	native.len = size;
+}
+
+void ArraySym::set_native(int idx, const uint8_t *val) {
+	auto elem_size = type.dropType().get_sizeof();
+	memcpy(native.data + idx * elem_size, val, elem_size);
+	native.valid[idx / 64] |= (uint64_t)1 << (idx % 64);
+}
+
+llvm::Value *ArraySym::load_native(NativeArr::Field field, LLVMCtx ctx) {
+	auto &b = *ctx.builder;
+	auto native_t = llvm::StructType::get(*ctx.ctx, {b.getInt8PtrTy(), b.getInt64Ty()->getPointerTo(),
+													 b.getInt32Ty()});
+	auto native_ptr = b.CreateBitCast(get_ptr(&native, ctx), native_t->getPointerTo());
+	auto field_ptr = b.CreateStructGEP(native_t, native_ptr, field);
+	return b.CreateLoad(native_t->getElementType(field), field_ptr);
+}
+
 llvm::Value *ArraySym::code_gen_idx(std::vector<llvm::Value *> &idx, LLVMCtx ctx) {
+	auto referenced_t = type;
+	for (int i = 0; i < idx.size(); i++) {
+		referenced_t = referenced_t.dropType();
+	}
+	auto elem_t = map_type_to_llvm_type(referenced_t, ctx);
+
+	if (idx.size() != 1 || !is_native()) {
+		return code_gen_idx_cb(idx, ctx);
+	}
+
+	//fast path: the element is already in the native buffer
+	auto &b = *ctx.builder;
+	auto func = b.GetInsertBlock()->getParent();
+	auto check_bb = llvm::BasicBlock::Create(*ctx.ctx, "native_check_bb", func);
+	auto load_bb = llvm::BasicBlock::Create(*ctx.ctx, "native_load_bb", func);
+	auto cb_bb = llvm::BasicBlock::Create(*ctx.ctx, "native_cb_bb", func);
+	auto merge_bb = llvm::BasicBlock::Create(*ctx.ctx, "native_merge_bb", func);
+
+	//len is 0 while the buffer isn't allocated
+	auto len = load_native(NativeArr::LEN, ctx);
+	b.CreateCondBr(b.CreateICmpULT(idx[0], len), check_bb, cb_bb);
+
+	b.SetInsertPoint(check_bb);
+	auto idx64 = b.CreateZExt(idx[0], b.getInt64Ty());
+	auto valid = load_native(NativeArr::VALID, ctx);
+	auto word = b.CreateLoad(b.getInt64Ty(), b.CreateGEP(b.getInt64Ty(), valid, b.CreateLShr(idx64, 6)));
+	auto bit = b.CreateAnd(b.CreateLShr(word, b.CreateAnd(idx64, 63)), 1);
+	b.CreateCondBr(b.CreateICmpNE(bit, b.getInt64(0)), load_bb, cb_bb);
+
+	b.SetInsertPoint(load_bb);
+	auto data = b.CreateBitCast(load_native(NativeArr::DATA, ctx), elem_t->getPointerTo());
+	auto native_val = b.CreateLoad(elem_t, b.CreateGEP(elem_t, data, idx64));
+	b.CreateBr(merge_bb);
+
+	b.SetInsertPoint(cb_bb);
+	auto cb_val = code_gen_idx_cb(idx, ctx);
+	cb_bb = b.GetInsertBlock();
+	b.CreateBr(merge_bb);
+
+	b.SetInsertPoint(merge_bb);
+	auto phi = b.CreatePHI(elem_t, 2);
+	phi->addIncoming(native_val, load_bb);
+	phi->addIncoming(cb_val, cb_bb);
+	return phi;
+}
+
+llvm::Value *ArraySym::code_gen_idx_cb(std::vector<llvm::Value *> &idx, LLVMCtx ctx) {
 	auto t = llvm::IntegerType::getInt32Ty(*ctx.ctx);
 	auto var_arr = ctx.builder->CreateAlloca(t, ctx.builder->getInt32(idx.size()), "arr_idxs");
 	for (int i = 0; i < idx.size(); i++) {
@@ -231,53 +339,64 @@ llvm::Value *ArraySym::code_gen_idx(std::vector<llvm::Value *> &idx, LLVMCtx ctx
 
 	auto dest_val = ctx.builder->CreateAlloca(map_type_to_llvm_type(referenced_t, ctx), nullptr, "dest_val");
 
-	//void (ArrSymbol *, int *idxs, int len, uint8_t *dest)
+	//void (ArrSymbol *, int *idxs, int len, uint8_t *dest, Runtime *rt)
 	auto idx_cb_t = llvm::FunctionType::get(llvm::Type::getVoidTy(*ctx.ctx),
 										  {llvm::Type::getInt8PtrTy(*ctx.ctx),
 										   llvm::Type::getInt32PtrTy(*ctx.ctx),
 										   llvm::Type::getInt32Ty(*ctx.ctx),
-										   dest_val->getAllocatedType()->getPointerTo()}, false);
+										   dest_val->getAllocatedType()->getPointerTo(),
+										   llvm::Type::getInt8PtrTy(*ctx.ctx)}, false);
 
 	auto idx_cb = ctx.mod->getOrInsertFunction("get_val_arr", idx_cb_t);
 
-	ctx.builder->CreateCall(idx_cb, {get_ptr(this, ctx), var_arr, ctx.builder->getInt32(idx.size()), dest_val});
+	ctx.builder->CreateCall(idx_cb, {get_ptr(this, ctx), var_arr, ctx.builder->getInt32(idx.size()), dest_val,
+									 get_ptr(ctx.rt, ctx)});
 
 	return ctx.builder->CreateLoad(dest_val->getAllocatedType(), dest_val);
 }
 
-std::string ArraySym::serialize() {
-	std::string tmp = "[";
-
+void ArraySym::serialize(Runtime &rt, Serializer &s, std::string &cell) {
 	//force to generate array
-	get_size();
+	get_size(*rt.rng);
 
-	for (auto &sym: arr) {
-		tmp += sym->serialize() + ",";
+	s.begin_array(cell, arr.size());
+	for (int i = 0; i < arr.size(); i++) {
+		if (i != 0) {
+			s.array_separator(cell);
+		}
+		arr[i]->serialize(rt, s, cell);
 	}
-	tmp[tmp.size()-1] = ']';
+	s.end_array(cell);
+}
 
-	return tmp;
+static void throw_out_of_bounds(ArraySym *arr, int idx, int size) {
+	throw TestAborted(TestAborted::OUT_OF_BOUNDS, "index " + std::to_string(idx) +
+					  " is out of the bounds of input \"" + arr->name + "\" of len " + std::to_string(size));
 }
 
-std::shared_ptr<Symbol> ArraySym::get_symbol_by_idxs(ArraySym *arr, std::vector<int> &idxs) {
+std::shared_ptr<Symbol> ArraySym::get_symbol_by_idxs(ArraySym *arr, std::vector<int> &idxs, Random &rng) {
 	int i;
 	for (i = 0; i < idxs.size() - 1; i++) {
-		auto arr_size = arr->get_size();
-		if (idxs[i] >= arr_size) {
-			throw std::runtime_error("out of bounds");
+		auto arr_size = arr->get_size(rng);
+		if (idxs[i] < 0 || idxs[i] >= arr_size) {
+			throw_out_of_bounds(arr, idxs[i], arr_size);
 		}
 		arr = dynamic_cast<ArraySym*>(arr->arr[idxs[i]].get());
 	}
 
-	auto arr_size = arr->get_size();
-	if (idxs[i] >= arr_size) {
-		throw std::runtime_error("out of bounds");
+	auto arr_size = arr->get_size(rng);
+	if (idxs[i] < 0 || idxs[i] >= arr_size) {
+		throw_out_of_bounds(arr, idxs[i], arr_size);
 	}
 	return arr->arr[idxs[i]];
 }
 
 void ArraySym::fill_val(z3::expr &expr) {
-	inited_size = expr.get_numeral_int64();
+	if (expr.is_bv()) {
+		inited_size = (int32_t)expr.get_numeral_uint64();
+	} else {
+		inited_size = expr.get_numeral_int64();
+	}
 	init_arr(*inited_size);
 }
 
@@ -292,33 +411,31 @@ void ArraySym::init_arr(int size) {
 void ArraySym::reset_val() {
 	inited_size.reset();
 	arr.clear();
+	//memory is released with the arena
+	native = NativeArr();
 }
 
 StringSym::StringSym(Position pos, Type type, std::string name, bool is_input):
 	ArraySym(pos, type, std::move(name), is_input) {}
 
-std::string StringSym::serialize() {
-	std::string tmp;
-
-	tmp += "\"";
-
+void StringSym::serialize(Runtime &rt, Serializer &s, std::string &cell) {
 	//to force generation of arr
-	get_size();
+	get_size(*rt.rng);
 
+	std::string tmp;
+	tmp.reserve(arr.size());
 	for (auto &el: arr) {
-		auto char_sym = std::dynamic_pointer_cast<CharSym>(el);
-		//TODO: escape char for json format
-		tmp += char_rand_gen(char_sym.get());
+		//elements of strings are always chars
+		tmp += char_rand_gen(static_cast<CharSym*>(el.get()), &rt);
 	}
 
-	tmp += "\"";
-	return tmp;
+	s.write_string(cell, tmp.data(), tmp.size());
 }
 
-extern "C" int8_t char_rand_gen(CharSym *sym) {
+extern "C" int8_t char_rand_gen(CharSym *sym, Runtime *rt) {
 	if (!sym->ch.has_value()) {
 		//TODO: generating chars from 32 to 126?
-		int r = std::abs(std::rand() % ('z'-'a'));
+		int r = (int)rt->rng->uniform('z'-'a');
 		sym->ch = 'a' + r;
 	}
 	return *sym->ch;
@@ -327,30 +444,36 @@ extern "C" int8_t char_rand_gen(CharSym *sym) {
 llvm::Value *CharSym::code_gen(LLVMCtx ctx) {
 	auto cb = ctx.mod->getOrInsertFunction("char_rand_gen", get_cb_func_type(ctx.ctx));
 	auto ptr = Symbol::get_ptr(this, ctx);
-	return ctx.builder->CreateCall(cb, {ptr});
+	return ctx.builder->CreateCall(cb, {ptr, Symbol::get_ptr(ctx.rt, ctx)});
 }
 
 CharSym::CharSym(Position pos, Type type, std::string name, bool is_input) : Symbol(pos, type, name, is_input) {}
 
 llvm::FunctionType *CharSym::get_cb_func_type(llvm::LLVMContext *ctx) {
-	return llvm::FunctionType::get(llvm::Type::getInt8Ty(*ctx), {llvm::Type::getInt8PtrTy(*ctx)}, false);
+	return llvm::FunctionType::get(llvm::Type::getInt8Ty(*ctx), {llvm::Type::getInt8PtrTy(*ctx),
+																llvm::Type::getInt8PtrTy(*ctx)}, false);
 }
 
 int CharSym::get_sizeof() {
 	return sizeof(uint8_t);
 }
 
-std::string CharSym::serialize() {
-	char c = char_rand_gen(this);
-
-	return std::to_string(c);
+void CharSym::serialize(Runtime &rt, Serializer &s, std::string &cell) {
+	s.write_char(cell, char_rand_gen(this, &rt));
 }
 
 bool CharSym::has_val() {
 	return ch.has_value();
 }
 
-z3::expr CharSym::get_expr(z3::context &ctx) {
+z3::expr CharSym::get_expr(z3::context &ctx, Z3Encoding encoding) {
+	if (encoding == Z3Encoding::BIT_VECTOR) {
+		if (ch.has_value()) {
+			return ctx.bv_val(*ch, 8);
+		}
+		return ctx.bv_const(name.c_str(), 8);
+	}
+
 	if (ch.has_value()) {
 		return ctx.int_val(*ch);
 	}
@@ -358,6 +481,11 @@ z3::expr CharSym::get_expr(z3::context &ctx) {
 }
 
 void CharSym::fill_val(z3::expr &expr) {
+	if (expr.is_bv()) {
+		ch = (int8_t)expr.get_numeral_uint64();
+		return;
+	}
+
 	//TODO: workaround to generate symbols inside 0:255
 	//should be in additional condition in solver?
 	ch = expr.get_numeral_int64() % 256;
@@ -367,9 +495,9 @@ void CharSym::reset_val() {
 	ch.reset();
 }
 
-extern "C" int8_t bool_rand_gen(BoolSym *sym) {
+extern "C" int8_t bool_rand_gen(BoolSym *sym, Runtime *rt) {
 	if (!sym->val.has_value()) {
-		sym->val = std::abs(std::rand() % 2);
+		sym->val = rt->rng->uniform(2);
 	}
 	return (int8_t)*sym->val;
 }
@@ -377,28 +505,25 @@ extern "C" int8_t bool_rand_gen(BoolSym *sym) {
 llvm::Value *BoolSym::code_gen(LLVMCtx ctx) {
 	auto cb = ctx.mod->getOrInsertFunction("bool_rand_gen", get_cb_func_type(ctx.ctx));
 	auto ptr = Symbol::get_ptr(this, ctx);
-	return ctx.builder->CreateCall(cb, {ptr});
+	return ctx.builder->CreateCall(cb, {ptr, Symbol::get_ptr(ctx.rt, ctx)});
 }
 
 BoolSym::BoolSym(Position pos, Type type, std::string name, bool is_input) : Symbol(pos, type, name, is_input) {}
 
 llvm::FunctionType *BoolSym::get_cb_func_type(llvm::LLVMContext *ctx) {
-	return llvm::FunctionType::get(llvm::Type::getInt8Ty(*ctx), {llvm::Type::getInt8PtrTy(*ctx)}, false);
+	return llvm::FunctionType::get(llvm::Type::getInt8Ty(*ctx), {llvm::Type::getInt8PtrTy(*ctx),
+																llvm::Type::getInt8PtrTy(*ctx)}, false);
 }
 
 int BoolSym::get_sizeof() {
 	return sizeof(uint8_t);
 }
 
-std::string BoolSym::serialize() {
-	std::string val = "false";
-	if (bool_rand_gen(this)) {
-		val = "true";
-	}
-	return val;
+void BoolSym::serialize(Runtime &rt, Serializer &s, std::string &cell) {
+	s.write_bool(cell, bool_rand_gen(this, &rt));
 }
 
-z3::expr BoolSym::get_expr(z3::context &ctx) {
+z3::expr BoolSym::get_expr(z3::context &ctx, Z3Encoding) {
 	if (val.has_value()) {
 		return ctx.bool_val(*val);
 	}
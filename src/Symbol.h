@@ -15,6 +15,14 @@
 #include <z3++.h>
 
 #include "LLVMCtx.h"
+#include "Options.h"
+#include "Runtime.h"
+
+//random lengths of the input arrays are in [0, bound),
+//lengths solved by z3 with bit vectors are kept in the same range
+#define ARR_LEN_BOUND 10
+
+class Serializer;
 
 class Symbol {
 public:
@@ -27,12 +35,6 @@ public:
 	//z3
 	void *addr = nullptr;
 
-	struct alloc_data {
-		bool is_alloc;
-		uint32_t size;
-	};
-	static std::unordered_map<uint8_t*, alloc_data> allocated_vals;
-
 	virtual llvm::Value *code_gen(LLVMCtx ctx);
 
 	llvm::AllocaInst *create_alloca(LLVMCtx ctx);
@@ -43,9 +45,10 @@ public:
 
 	virtual int get_sizeof();
 	static llvm::Value *get_ptr(void *ptr, LLVMCtx ctx);
-	virtual std::string serialize();
+	//writes the value (generating it if needed) to the cell of the test
+	virtual void serialize(Runtime &rt, Serializer &s, std::string &cell);
 
-	virtual z3::expr get_expr(z3::context &ctx);
+	virtual z3::expr get_expr(z3::context &ctx, Z3Encoding encoding);
 	virtual void fill_val(z3::expr &expr);
 	virtual bool has_val();
 	virtual void reset_val() = 0;
@@ -53,11 +56,28 @@ protected:
 	explicit Symbol(Position pos, Type type, std::string name, bool is_input = false);
 };
 
+//flat copy of the generated elements of one dimensional input array,
+//generated code reads it directly and calls back only on the first touch of an element
+struct NativeArr {
+	enum Field {
+		DATA,
+		VALID,
+		LEN
+	};
+
+	//nullptr until the size is known, allocated in the worker's arena
+	uint8_t *data = nullptr;
+	//bit per element, set when the element is copied to data
+	uint64_t *valid = nullptr;
+	int32_t len = 0;
+};
+
 class ArraySym: public Symbol {
 public:
 	std::vector<std::shared_ptr<Symbol>> arr;
 	//init when first access to "len" or some element
 	std::optional<int> inited_size;
+	NativeArr native;
 
 	//when access to element generate it with new Symbol
 	//and insert at corresponding position but don't initialize it
@@ -68,18 +88,26 @@ public:
 	explicit ArraySym(Position pos, Type type, std::string name, bool is_input = false);
 	llvm::Value *code_gen(LLVMCtx ctx) override;
 	llvm::Value *code_gen_idx(std::vector<llvm::Value*> &idx, LLVMCtx ctx);
-	int get_size();
+	int get_size(Random &rng);
 	std::shared_ptr<Symbol> get_pointed_type_elem();
 	int get_sizeof() override;
-	static std::shared_ptr<Symbol> get_symbol_by_idxs(ArraySym *arr, std::vector<int> &idxs);
+	static std::shared_ptr<Symbol> get_symbol_by_idxs(ArraySym *arr, std::vector<int> &idxs, Random &rng);
+
+	//arrays of scalars are backed by the native buffer
+	bool is_native();
+	void materialize(Runtime &rt);
+	//copies the generated element to the native buffer
+	void set_native(int idx, const uint8_t *val);
+	llvm::Value *load_native(NativeArr::Field field, LLVMCtx ctx);
 
-	std::string serialize() override;
+	void serialize(Runtime &rt, Serializer &s, std::string &cell) override;
 
 	static llvm::FunctionType *get_cb_func_type(llvm::Type *ret_type, llvm::LLVMContext *ctx);
 	void fill_val(z3::expr &expr) override;
 	void reset_val() override;
 private:
 	void init_arr(int size);
+	llvm::Value *code_gen_idx_cb(std::vector<llvm::Value*> &idx, LLVMCtx ctx);
 };
 
 class NumberSym: public Symbol {
@@ -93,9 +121,9 @@ public:
 
 	static llvm::FunctionType *get_cb_func_type(llvm::LLVMContext *ctx);
 
-	std::string serialize() override;
+	void serialize(Runtime &rt, Serializer &s, std::string &cell) override;
 
-	z3::expr get_expr(z3::context &ctx) override;
+	z3::expr get_expr(z3::context &ctx, Z3Encoding encoding) override;
 
 	void fill_val(z3::expr &expr) override;
 
@@ -115,9 +143,9 @@ public:
 
 	static llvm::FunctionType *get_cb_func_type(llvm::LLVMContext *ctx);
 
-	std::string serialize() override;
+	void serialize(Runtime &rt, Serializer &s, std::string &cell) override;
 
-	z3::expr get_expr(z3::context &ctx) override;
+	z3::expr get_expr(z3::context &ctx, Z3Encoding encoding) override;
 
 	void fill_val(z3::expr &expr) override;
 
@@ -137,9 +165,9 @@ public:
 
 	static llvm::FunctionType *get_cb_func_type(llvm::LLVMContext *ctx);
 
-	std::string serialize() override;
+	void serialize(Runtime &rt, Serializer &s, std::string &cell) override;
 
-	z3::expr get_expr(z3::context &ctx) override;
+	z3::expr get_expr(z3::context &ctx, Z3Encoding encoding) override;
 
 	void fill_val(z3::expr &expr) override;
 
@@ -152,7 +180,7 @@ class StringSym: public ArraySym {
 public:
 	explicit StringSym(Position pos, Type type, std::string name, bool is_input = false);
 	//todo: override generation of json value
-	std::string serialize() override;
+	void serialize(Runtime &rt, Serializer &s, std::string &cell) override;
 };
 
 
@@ -5,14 +5,28 @@
 #include <utility>
 
 #include "ast.h"
+#include "ASTArena.h"
 #include "utils/assert.h"
 #include "BuildError.h"
 #include "CodegenVisitor.h"
+#include "Interpreter.h"
 
 #define OFFSET 4
 
-ASTNode::ASTNode(Position pos, std::vector<ASTNode *> children) :
-		pos(pos), children(std::move(children)) {}
+ASTNode::ASTNode(NodeKind kind, Position pos, std::vector<ASTNode *> children) :
+		children(std::move(children)), kind(kind), pos(pos) {}
+
+void *ASTNode::operator new(size_t size) {
+	auto arena = ASTArena::current();
+	if (!arena) {
+		throw std::runtime_error("ast node is created outside of an ast arena");
+	}
+	return arena->alloc_node(size);
+}
+
+void ASTNode::operator delete(void *ptr) {
+	ASTArena::current()->forget_node(ptr);
+}
 
 void ASTNode::print_spaces(std::ostream &out, int offset) {
 	for (int i = 0; i < offset; i++) {
@@ -28,15 +42,6 @@ void ASTNode::print(std::ostream &out, int offset) {
 	}
 }
 
-void ASTNode::visitChildren(ASTTraverser cb, std::any ctx) {
-	for (const auto &child: children) {
-		if (!child) continue;
-		//ctx may change => it's updated in the next
-		bool traverse_children = cb(child, ctx);
-		if (traverse_children) child->visitChildren(cb, ctx);
-	}
-}
-
 Type ASTNode::get_type() {
 	return Type(TypeKind::INVALID);
 }
@@ -45,6 +50,10 @@ llvm::Value *ASTNode::code_gen(CodegenVisitor *visitor) {
 	return nullptr;
 }
 
+InterpValue ASTNode::eval(Interpreter *interp) {
+	throw std::runtime_error("eval on wrong ast node");
+}
+
 z3::expr ASTNode::gen_expr(CodegenZ3Visitor *visitor) {
 	throw std::runtime_error("gen expr on wrong ast node");
 }
@@ -53,17 +62,9 @@ ASTNode *ASTNode::copy() {
 	return this;
 }
 
-ASTNode::~ASTNode() {
-	for (auto child: children) {
-		if (child) {
-			delete child;
-		}
-	}
-}
-
 FunctionNode::FunctionNode(Position pos, Type ret_type, std::string name,
 						   std::vector<DefNode *> args, BodyNode *body):
-	ASTNode(pos, {body}), ret_type(ret_type), name(std::move(name)),
+	ASTNode(KIND, pos, {body}), ret_type(ret_type), name(std::move(name)),
 	args(std::move(args)), body(body) {
 	for (const auto arg: this->args) {
 		children.push_back(arg);
@@ -77,7 +78,7 @@ void FunctionNode::print(std::ostream &out, int offset) {
 }
 
 BodyNode::BodyNode(Position pos, std::vector<ASTNode *> stmts):
-	ASTNode(pos), stmts(std::move(stmts)) {
+	ASTNode(KIND, pos), stmts(std::move(stmts)) {
 	for (const auto stmt: this->stmts) {
 		children.push_back(stmt);
 	}
@@ -87,6 +88,10 @@ llvm::Value *BodyNode::code_gen(CodegenVisitor *visitor) {
 	return visitor->code_gen(this);
 }
 
+InterpValue BodyNode::eval(Interpreter *interp) {
+	return interp->eval(this);
+}
+
 void BodyNode::print(std::ostream &out, int offset) {
 	print_spaces(out, offset);
 	out << "BodyNode:" << std::endl;
@@ -97,7 +102,7 @@ void BodyNode::print(std::ostream &out, int offset) {
 
 IfNode::IfNode(Position pos, PrecondNode *precond, ASTNode *cond,
 			   BodyNode *body, BodyNode *else_body):
-	ASTNode(pos, {precond, cond, body, else_body}), precond(precond), cond(cond), body(body), else_body(else_body) {
+	ASTNode(KIND, pos, {precond, cond, body, else_body}), precond(precond), cond(cond), body(body), else_body(else_body) {
 }
 
 void IfNode::print(std::ostream &out, int offset) {
@@ -113,9 +118,13 @@ llvm::Value *IfNode::code_gen(CodegenVisitor *visitor) {
 	return visitor->code_gen(this);
 }
 
+InterpValue IfNode::eval(Interpreter *interp) {
+	return interp->eval(this);
+}
+
 ForNode::ForNode(Position pos, PrecondNode *precond, ASTNode *pre_asg, ASTNode *cond,
 				 ASTNode *inc_asg, BodyNode *body):
-	ASTNode(pos, {precond, pre_asg, cond, inc_asg, body}), precond(precond),
+	ASTNode(KIND, pos, {precond, pre_asg, cond, inc_asg, body}), precond(precond),
 	pre_asg(static_cast<AsgNode*>(pre_asg)), cond(cond),
 	inc_asg(static_cast<AsgNode*>(inc_asg)),
 	body(body) {}
@@ -130,8 +139,12 @@ llvm::Value *ForNode::code_gen(CodegenVisitor *visitor) {
 	return visitor->code_gen(this);
 }
 
+InterpValue ForNode::eval(Interpreter *interp) {
+	return interp->eval(this);
+}
+
 DefNode::DefNode(Position pos, std::string name, Type type, ASTNode *rhs):
-	ASTNode(pos, {rhs}), name(std::move(name)), type(type), rhs(rhs) {}
+	ASTNode(KIND, pos, {rhs}), name(std::move(name)), type(type), rhs(rhs) {}
 
 void DefNode::print(std::ostream &out, int offset) {
 	print_spaces(out, offset);
@@ -149,7 +162,11 @@ llvm::Value *DefNode::code_gen(CodegenVisitor *visitor) {
 	return visitor->code_gen(this);
 }
 
-ContinueNode::ContinueNode(Position pos): ASTNode(pos) {}
+InterpValue DefNode::eval(Interpreter *interp) {
+	return interp->eval(this);
+}
+
+ContinueNode::ContinueNode(Position pos): ASTNode(KIND, pos) {}
 
 void ContinueNode::print(std::ostream &out, int offset) {
 	print_spaces(out, offset);
@@ -160,7 +177,11 @@ llvm::Value *ContinueNode::code_gen(CodegenVisitor *visitor) {
 	return visitor->code_gen(this);
 }
 
-BreakNode::BreakNode(Position pos): ASTNode(pos) {}
+InterpValue ContinueNode::eval(Interpreter *interp) {
+	return interp->eval(this);
+}
+
+BreakNode::BreakNode(Position pos): ASTNode(KIND, pos) {}
 
 void BreakNode::print(std::ostream &out, int offset) {
 	print_spaces(out, offset);
@@ -171,7 +192,11 @@ llvm::Value *BreakNode::code_gen(CodegenVisitor *visitor) {
 	return visitor->code_gen(this);
 }
 
-ReturnNode::ReturnNode(Position pos, ASTNode *expr): ASTNode(pos, {expr}), expr(expr) {}
+InterpValue BreakNode::eval(Interpreter *interp) {
+	return interp->eval(this);
+}
+
+ReturnNode::ReturnNode(Position pos, ASTNode *expr): ASTNode(KIND, pos, {expr}), expr(expr) {}
 
 void ReturnNode::print(std::ostream &out, int offset) {
 	print_spaces(out, offset);
@@ -183,8 +208,12 @@ llvm::Value *ReturnNode::code_gen(CodegenVisitor *visitor) {
 	visitor->code_gen(this);
 }
 
+InterpValue ReturnNode::eval(Interpreter *interp) {
+	return interp->eval(this);
+}
+
 AsgNode::AsgNode(Position pos, ASTNode *lhs, ASTNode *rhs):
-		ASTNode(pos, {lhs, rhs}), lhs(lhs), rhs(rhs) {}
+		ASTNode(KIND, pos, {lhs, rhs}), lhs(lhs), rhs(rhs) {}
 
 void AsgNode::print(std::ostream &out, int offset) {
 	print_spaces(out, offset);
@@ -233,6 +262,10 @@ llvm::Value *AsgNode::code_gen(CodegenVisitor *visitor) {
 	return visitor->code_gen(this);
 }
 
+InterpValue AsgNode::eval(Interpreter *interp) {
+	return interp->eval(this);
+}
+
 AsgNode *CremNode::create(Position pos, ASTNode *lhs, const std::string &type) {
 	BinOpNode *rhs = nullptr;
 	switch (map_crem_type(type)) {
@@ -255,7 +288,7 @@ CremType CremNode::map_crem_type(const std::string &type) {
 	ASSERT(false, "invalid crem type " + type);
 }
 
-CharNode::CharNode(Position pos, char ch): ASTNode(pos), ch(ch) {}
+CharNode::CharNode(Position pos, char ch): ASTNode(KIND, pos), ch(ch) {}
 
 CharNode *CharNode::create(Position pos, antlr4::tree::TerminalNode *token) {
 	auto ch = token->getText()[1];
@@ -270,6 +303,10 @@ llvm::Value *CharNode::code_gen(CodegenVisitor *visitor) {
 	return visitor->code_gen(this);
 }
 
+InterpValue CharNode::eval(Interpreter *interp) {
+	return interp->eval(this);
+}
+
 void CharNode::print(std::ostream &out, int offset) {
 	print_spaces(out, offset);
 	out << ch << "(" << (int)ch << ")" << std::endl;
@@ -279,7 +316,7 @@ z3::expr CharNode::gen_expr(CodegenZ3Visitor *visitor) {
 	return visitor->gen_expr(this);
 }
 
-StringNode::StringNode(Position pos, std::string str): ASTNode(pos), str(std::move(str)) {}
+StringNode::StringNode(Position pos, std::string str): ASTNode(KIND, pos), str(std::move(str)) {}
 
 Type StringNode::get_type() {
 	return TypeKind::STRING;
@@ -289,7 +326,11 @@ llvm::Value *StringNode::code_gen(CodegenVisitor *visitor) {
 	return visitor->code_gen(this);
 }
 
-NumberNode::NumberNode(Position pos, int num): ASTNode(pos), num(num) {}
+InterpValue StringNode::eval(Interpreter *interp) {
+	return interp->eval(this);
+}
+
+NumberNode::NumberNode(Position pos, int num): ASTNode(KIND, pos), num(num) {}
 
 NumberNode *NumberNode::create(Position pos, antlr4::tree::TerminalNode *token) {
 	int num = std::atoi(token->getText().c_str());
@@ -304,6 +345,10 @@ llvm::Value *NumberNode::code_gen(CodegenVisitor *visitor) {
 	return visitor->code_gen(this);
 }
 
+InterpValue NumberNode::eval(Interpreter *interp) {
+	return interp->eval(this);
+}
+
 z3::expr NumberNode::gen_expr(CodegenZ3Visitor *visitor) {
 	return visitor->gen_expr(this);
 }
@@ -312,7 +357,7 @@ ASTNode *NumberNode::copy() {
 	return new NumberNode(pos, num);
 }
 
-BoolNode::BoolNode(Position pos, bool val): ASTNode(pos), val(val) {}
+BoolNode::BoolNode(Position pos, bool val): ASTNode(KIND, pos), val(val) {}
 
 BoolNode *BoolNode::create(Position pos, antlr4::tree::TerminalNode *token) {
 	switch (token->getText()[0]) {
@@ -331,11 +376,15 @@ llvm::Value *BoolNode::code_gen(CodegenVisitor *visitor) {
 	return visitor->code_gen(this);
 }
 
+InterpValue BoolNode::eval(Interpreter *interp) {
+	return interp->eval(this);
+}
+
 z3::expr BoolNode::gen_expr(CodegenZ3Visitor *visitor) {
 	return visitor->gen_expr(this);
 }
 
-IdentNode::IdentNode(Position pos, std::string name): ASTNode(pos), name(std::move(name)) {}
+IdentNode::IdentNode(Position pos, std::string name): ASTNode(KIND, pos), name(std::move(name)) {}
 
 Type IdentNode::get_type() {
 	return symbol->type;
@@ -345,6 +394,10 @@ llvm::Value *IdentNode::code_gen(CodegenVisitor *visitor) {
 	return visitor->code_gen(this);
 }
 
+InterpValue IdentNode::eval(Interpreter *interp) {
+	return interp->eval(this);
+}
+
 z3::expr IdentNode::gen_expr(CodegenZ3Visitor *visitor) {
 	return visitor->gen_expr(this);
 }
@@ -354,7 +407,7 @@ ASTNode *IdentNode::copy() {
 }
 
 BinOpNode::BinOpNode(Position pos, BinOpType op_type, ASTNode *lhs, ASTNode *rhs):
-	ASTNode(pos, {lhs, rhs}), lhs(lhs), rhs(rhs), op_type(op_type) {}
+	ASTNode(KIND, pos, {lhs, rhs}), lhs(lhs), rhs(rhs), op_type(op_type) {}
 
 BinOpType BinOpNode::map_op_type(const std::string& op_type) {
 	if (op_type == "+") {
@@ -510,6 +563,10 @@ llvm::Value *BinOpNode::code_gen(CodegenVisitor *visitor) {
 	return visitor->code_gen(this);
 }
 
+InterpValue BinOpNode::eval(Interpreter *interp) {
+	return interp->eval(this);
+}
+
 z3::expr BinOpNode::gen_expr(CodegenZ3Visitor *visitor) {
 	return visitor->gen_expr(this);
 }
@@ -519,7 +576,7 @@ ASTNode *BinOpNode::copy() {
 }
 
 ArrLookupNode::ArrLookupNode(Position pos, std::string ident_name, std::vector<ASTNode*> idxs):
-		ASTNode(pos), idxs(std::move(idxs)) {
+		ASTNode(KIND, pos), idxs(std::move(idxs)) {
 	ident = new IdentNode(pos, std::move(ident_name));
 	children.push_back(ident);
 	for (const auto &idx: this->idxs) {
@@ -551,6 +608,10 @@ llvm::Value *ArrLookupNode::code_gen(CodegenVisitor *visitor) {
 	return visitor->code_gen(this);
 }
 
+InterpValue ArrLookupNode::eval(Interpreter *interp) {
+	return interp->eval(this);
+}
+
 z3::expr ArrLookupNode::gen_expr(CodegenZ3Visitor *visitor) {
 	return visitor->gen_expr(this);
 }
@@ -565,12 +626,10 @@ ASTNode *ArrLookupNode::copy() {
 }
 
 ArrCreateNode::ArrCreateNode(Position pos, Type type, ASTNode *len):
-	ASTNode(pos, {len}), type(type), len(len) {}
+	ASTNode(KIND, pos, {len}), type(type), len(len) {}
 
 ArrCreateNode *ArrCreateNode::create(Position pos, Type type, ASTNode *len) {
-	auto types = type.types;
-	types->insert(types->begin(), TypeKind::ARR);
-	return new ArrCreateNode(pos, type, len);
+	return new ArrCreateNode(pos, Type::array_of(type), len);
 }
 
 Type ArrCreateNode::get_type() {
@@ -581,8 +640,12 @@ llvm::Value *ArrCreateNode::code_gen(CodegenVisitor *visitor) {
 	return visitor->code_gen(this);
 }
 
+InterpValue ArrCreateNode::eval(Interpreter *interp) {
+	return interp->eval(this);
+}
+
 PropertyLookupNode::PropertyLookupNode(Position pos, std::string ident_name, std::string property_name):
-		ASTNode(pos), property_name(std::move(property_name)) {
+		ASTNode(KIND, pos), property_name(std::move(property_name)) {
 	ident = new IdentNode(pos, std::move(ident_name));
 	children.push_back(ident);
 }
@@ -602,6 +665,10 @@ llvm::Value *PropertyLookupNode::code_gen(CodegenVisitor *visitor) {
 	return visitor->code_gen(this);
 }
 
+InterpValue PropertyLookupNode::eval(Interpreter *interp) {
+	return interp->eval(this);
+}
+
 z3::expr PropertyLookupNode::gen_expr(CodegenZ3Visitor *visitor) {
 	return visitor->gen_expr(this);
 }
@@ -611,4 +678,4 @@ ASTNode *PropertyLookupNode::copy() {
 }
 
 PrecondNode::PrecondNode(Position pos, int prob, ASTNode *expr):
-	ASTNode(pos, {expr}), prob(prob), expr(expr) {}
+	ASTNode(KIND, pos, {expr}), prob(prob), expr(expr) {}
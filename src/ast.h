@@ -23,22 +23,61 @@ namespace llvm {
 
 class CodegenVisitor;
 class CodegenZ3Visitor;
+class Interpreter;
+struct InterpValue;
+
+//tag of the node class, see node_cast
+enum class NodeKind {
+	FUNCTION,
+	BODY,
+	PRECOND,
+	IF,
+	FOR,
+	DEF,
+	CONTINUE,
+	BREAK,
+	RETURN,
+	ASG,
+	CHAR,
+	STRING,
+	NUMBER,
+	BOOL,
+	IDENT,
+	BIN_OP,
+	ARR_LOOKUP,
+	ARR_CREATE,
+	PROPERTY_LOOKUP
+};
 
+//nodes are allocated in the ASTArena of the current thread and destroyed with it
 class ASTNode {
 protected:
 	std::vector<ASTNode*> children;
 public:
-	using ASTTraverser = const std::function<bool(ASTNode *, std::any&)>&;
-
+	const NodeKind kind;
 	Position pos;
 
-	explicit ASTNode(Position pos, std::vector<ASTNode*> children = std::vector<ASTNode*>());;
-	virtual ~ASTNode();
+	explicit ASTNode(NodeKind kind, Position pos, std::vector<ASTNode*> children = std::vector<ASTNode*>());
+	virtual ~ASTNode() = default;
+
+	static void *operator new(size_t size);
+	//called only if the constructor throws, the memory belongs to the arena
+	static void operator delete(void *ptr);
+
 	void print_spaces(std::ostream &out, int offset);
-	void visitChildren(ASTTraverser cb, std::any ctx);
+	//pre-order walk, the children of a node are skipped if cb(node) returns false
+	template<class F>
+	void visitChildren(F &&cb) {
+		for (auto child: children) {
+			if (child && cb(child)) {
+				child->visitChildren(cb);
+			}
+		}
+	}
 	virtual void print(std::ostream &out, int offset);
 	virtual z3::expr gen_expr(CodegenZ3Visitor *visitor);
 	virtual llvm::Value *code_gen(CodegenVisitor *visitor);
+	virtual InterpValue eval(Interpreter *interp);
 	virtual Type get_type();
 	virtual ASTNode *copy();
 };
@@ -46,8 +85,15 @@ public:
 class DefNode;
 class BodyNode;
 
+//checked by the kind tag, nullptr if the node is of another class
+template<class T>
+T *node_cast(ASTNode *node) {
+	return node && node->kind == T::KIND ? static_cast<T*>(node) : nullptr;
+}
+
 class FunctionNode: public ASTNode {
 public:
+	static constexpr NodeKind KIND = NodeKind::FUNCTION;
 	Type ret_type;
 	std::string name;
 	std::vector<DefNode*> args;
@@ -60,16 +106,19 @@ public:
 
 class BodyNode: public ASTNode {
 public:
+	static constexpr NodeKind KIND = NodeKind::BODY;
 	std::vector<ASTNode*> stmts;
 	explicit BodyNode(Position pos, std::vector<ASTNode*> stmts);
 
 	void print(std::ostream &out, int offset) override;
 
 	llvm::Value *code_gen(CodegenVisitor *visitor) override;
+	InterpValue eval(Interpreter *interp) override;
 };
 
 class PrecondNode: public ASTNode {
 public:
+	static constexpr NodeKind KIND = NodeKind::PRECOND;
 	int prob = -1;
 	ASTNode *expr = nullptr;
 	explicit PrecondNode(Position pos, int prob, ASTNode *expr);
@@ -77,6 +126,7 @@ public:
 
 class IfNode: public ASTNode {
 public:
+	static constexpr NodeKind KIND = NodeKind::IF;
 	PrecondNode *precond;
 	ASTNode *cond;
 	BodyNode *body, *else_body;
@@ -85,11 +135,13 @@ public:
 	void print(std::ostream &out, int offset) override;
 
 	llvm::Value * code_gen(CodegenVisitor *visitor) override;
+	InterpValue eval(Interpreter *interp) override;
 };
 
 class AsgNode;
 class ForNode: public ASTNode {
 public:
+	static constexpr NodeKind KIND = NodeKind::FOR;
 	PrecondNode *precond;
 	AsgNode *pre_asg;
 	ASTNode *cond;
@@ -105,10 +157,12 @@ public:
 	void print(std::ostream &out, int offset) override;
 
 	llvm::Value * code_gen(CodegenVisitor *visitor) override;
+	InterpValue eval(Interpreter *interp) override;
 };
 
 class DefNode: public ASTNode {
 public:
+	static constexpr NodeKind KIND = NodeKind::DEF;
 	std::string name;
 	Type type;
 	ASTNode *rhs;
@@ -118,35 +172,42 @@ public:
 	void print(std::ostream &out, int offset) override;
 
 	llvm::Value * code_gen(CodegenVisitor *visitor) override;
+	InterpValue eval(Interpreter *interp) override;
 };
 
 class ContinueNode: public ASTNode {
 public:
+	static constexpr NodeKind KIND = NodeKind::CONTINUE;
 	ForNode *loop;
 	explicit ContinueNode(Position pos);
 
 	void print(std::ostream &out, int offset) override;
 
 	llvm::Value * code_gen(CodegenVisitor *visitor) override;
+	InterpValue eval(Interpreter *interp) override;
 };
 
 class BreakNode: public ASTNode {
 public:
+	static constexpr NodeKind KIND = NodeKind::BREAK;
 	ForNode *loop;
 	explicit BreakNode(Position pos);
 
 	void print(std::ostream &out, int offset) override;
 	llvm::Value * code_gen(CodegenVisitor *visitor) override;
+	InterpValue eval(Interpreter *interp) override;
 };
 
 class ReturnNode: public ASTNode {
 public:
+	static constexpr NodeKind KIND = NodeKind::RETURN;
 	ASTNode *expr;
 	explicit ReturnNode(Position pos, ASTNode *expr);
 
 	void print(std::ostream &out, int offset) override;
 
 	llvm::Value * code_gen(CodegenVisitor *visitor) override;
+	InterpValue eval(Interpreter *interp) override;
 };
 
 enum class AsgType {
@@ -159,11 +220,13 @@ enum class AsgType {
 
 class AsgNode: public ASTNode {
 public:
+	static constexpr NodeKind KIND = NodeKind::ASG;
 	ASTNode *lhs;
 	ASTNode *rhs;
 	explicit AsgNode(Position pos, ASTNode *lhs, ASTNode *rhs);
 	static AsgNode *create(Position pos, ASTNode *lhs, const std::string &type, ASTNode *rhs);
 	llvm::Value *code_gen(CodegenVisitor *visitor) override;
+	InterpValue eval(Interpreter *interp) override;
 private:
 	static AsgType map_asg_type(const std::string &type);
 
@@ -185,6 +248,7 @@ private:
 
 class CharNode: public ASTNode {
 public:
+	static constexpr NodeKind KIND = NodeKind::CHAR;
 	char ch;
 	explicit CharNode(Position pos, char ch);
 	static CharNode *create(Position pos, antlr4::tree::TerminalNode *token);
@@ -194,28 +258,33 @@ public:
 	Type get_type() override;
 
 	llvm::Value * code_gen(CodegenVisitor *visitor) override;
+	InterpValue eval(Interpreter *interp) override;
 
 	z3::expr gen_expr(CodegenZ3Visitor *visitor) override;
 };
 
 class StringNode: public ASTNode {
 public:
+	static constexpr NodeKind KIND = NodeKind::STRING;
 	std::string str;
 	explicit StringNode(Position pos, std::string str);
 
 	Type get_type() override;
 
 	llvm::Value * code_gen(CodegenVisitor *visitor) override;
+	InterpValue eval(Interpreter *interp) override;
 };
 
 class NumberNode: public ASTNode {
 public:
+	static constexpr NodeKind KIND = NodeKind::NUMBER;
 	int num;
 	explicit NumberNode(Position pos, int num);
 	static NumberNode *create(Position pos, antlr4::tree::TerminalNode *token);
 
 	Type get_type() override;
 	llvm::Value * code_gen(CodegenVisitor *visitor) override;
+	InterpValue eval(Interpreter *interp) override;
 
 	z3::expr gen_expr(CodegenZ3Visitor *visitor) override;
 
@@ -224,17 +293,20 @@ public:
 
 class BoolNode: public ASTNode {
 public:
+	static constexpr NodeKind KIND = NodeKind::BOOL;
 	bool val;
 	explicit BoolNode(Position pos, bool val);
 	static BoolNode *create(Position pos, antlr4::tree::TerminalNode *token);
 
 	Type get_type() override;
 	llvm::Value * code_gen(CodegenVisitor *visitor) override;
+	InterpValue eval(Interpreter *interp) override;
 	z3::expr gen_expr(CodegenZ3Visitor *visitor) override;
 };
 
 class IdentNode: public ASTNode {
 public:
+	static constexpr NodeKind KIND = NodeKind::IDENT;
 	std::string name;
 	//type
 	std::shared_ptr<Symbol> symbol;
@@ -243,6 +315,7 @@ public:
 	Type get_type() override;
 
 	llvm::Value * code_gen(CodegenVisitor *visitor) override;
+	InterpValue eval(Interpreter *interp) override;
 
 	z3::expr gen_expr(CodegenZ3Visitor *visitor) override;
 
@@ -275,6 +348,7 @@ enum class BinOpGroup {
 
 class BinOpNode: public ASTNode {
 public:
+	static constexpr NodeKind KIND = NodeKind::BIN_OP;
 	ASTNode *lhs, *rhs;
 	BinOpType op_type;
 	explicit BinOpNode(Position pos, BinOpType op_type, ASTNode *lhs, ASTNode *rhs);
@@ -282,6 +356,7 @@ public:
 	void print(std::ostream &out, int offset) override;
 	Type get_type() override;
 	llvm::Value * code_gen(CodegenVisitor *visitor) override;
+	InterpValue eval(Interpreter *interp) override;
 
 	z3::expr gen_expr(CodegenZ3Visitor *visitor) override;
 
@@ -295,6 +370,7 @@ private:
 
 class ArrLookupNode: public ASTNode {
 public:
+	static constexpr NodeKind KIND = NodeKind::ARR_LOOKUP;
 	IdentNode *ident;
 	std::vector<ASTNode*> idxs;
 
@@ -311,6 +387,7 @@ public:
 	Type get_type() override;
 
 	llvm::Value *code_gen(CodegenVisitor *visitor) override;
+	InterpValue eval(Interpreter *interp) override;
 
 	z3::expr gen_expr(CodegenZ3Visitor *visitor) override;
 
@@ -319,6 +396,7 @@ public:
 
 class ArrCreateNode: public ASTNode {
 public:
+	static constexpr NodeKind KIND = NodeKind::ARR_CREATE;
 	Type type;
 	ASTNode *len;
 	explicit ArrCreateNode(Position pos, Type type, ASTNode *len);
@@ -327,10 +405,12 @@ public:
 	Type get_type() override;
 
 	llvm::Value * code_gen(CodegenVisitor *visitor) override;
+	InterpValue eval(Interpreter *interp) override;
 };
 
 class PropertyLookupNode: public ASTNode {
 public:
+	static constexpr NodeKind KIND = NodeKind::PROPERTY_LOOKUP;
 	IdentNode *ident;
 	std::string property_name;
 	explicit PropertyLookupNode(Position pos, std::string ident_name, std::string property_name);
@@ -338,6 +418,7 @@ public:
 	Type get_type() override;
 
 	llvm::Value * code_gen(CodegenVisitor *visitor) override;
+	InterpValue eval(Interpreter *interp) override;
 
 	z3::expr gen_expr(CodegenZ3Visitor *visitor) override;
 
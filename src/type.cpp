@@ -3,27 +3,72 @@
 //
 
 #include <iterator>
+#include <mutex>
+#include <stdexcept>
 #include <utility>
 
 #include "type.h"
 #include "utils/assert.h"
 
-Type::Type(std::shared_ptr<std::vector<TypeKind>> types): types(std::move(types)) {}
+//the predefined types are constant initialized, so they can be used during static initialization.
+//entries are never changed after their id is published through arr_of
+Type::Info Type::table[MAX_TYPES] = {
+		{TypeKind::INVALID, INVALID_ID, TypeKind::INVALID, 0, 0, {0}},
+		{TypeKind::INT, INVALID_ID, TypeKind::INT, 1, sizeof(int32_t), {0}},
+		{TypeKind::STRING, CHAR_ID, TypeKind::STRING, 1, sizeof(uint8_t*), {0}},
+		{TypeKind::CHAR, INVALID_ID, TypeKind::CHAR, 1, sizeof(int8_t), {CHAR_ARR_ID}},
+		{TypeKind::BOOL, INVALID_ID, TypeKind::BOOL, 1, sizeof(int8_t), {0}},
+		{TypeKind::ARR, CHAR_ID, TypeKind::CHAR, 2, sizeof(uint8_t*), {0}},
+};
+std::atomic<uint32_t> Type::types_num{PREDEFINED_NUM};
+
+//workers build their programs in parallel
+static std::mutex intern_mtx;
 
-TypeKind Type::getCurrentType() const {
-	if (pos >= types->size()) {
-		return TypeKind::INVALID;
+Type::Type(TypeKind type) {
+	switch (type) {
+		case TypeKind::INT:
+			id = INT_ID;
+			break;
+		case TypeKind::STRING:
+			id = STRING_ID;
+			break;
+		case TypeKind::CHAR:
+			id = CHAR_ID;
+			break;
+		case TypeKind::BOOL:
+			id = BOOL_ID;
+			break;
+		default:
+			id = INVALID_ID;
 	}
-	return types->at(pos);
 }
 
-Type Type::dropType() const {
-	if (*this == TypeKind::STRING) {
-		return TypeKind::CHAR;
+Type Type::array_of(Type elem) {
+	auto &elem_info = table[elem.id];
+	auto arr_id = elem_info.arr_of.load(std::memory_order_acquire);
+	if (arr_id != 0) {
+		return Type(arr_id);
+	}
+
+	std::lock_guard<std::mutex> lock(intern_mtx);
+	arr_id = elem_info.arr_of.load(std::memory_order_relaxed);
+	if (arr_id != 0) {
+		return Type(arr_id);
 	}
-	auto dropped = *this;
-	dropped.pos++;
-	return dropped;
+	arr_id = types_num.load(std::memory_order_relaxed);
+	if (arr_id >= MAX_TYPES) {
+		throw std::runtime_error("too many types");
+	}
+	auto &info = table[arr_id];
+	info.kind = TypeKind::ARR;
+	info.elem = elem.id;
+	info.scalar = elem_info.scalar;
+	info.length = elem_info.length + 1;
+	info.size = sizeof(uint8_t*);
+	types_num.store(arr_id + 1, std::memory_order_relaxed);
+	elem_info.arr_of.store(arr_id, std::memory_order_release);
+	return Type(arr_id);
 }
 
 TypeKind Type::map_type(const std::string &type) {
@@ -43,26 +88,26 @@ TypeKind Type::map_type(const std::string &type) {
 }
 
 Type Type::create(std::vector<antlr4::Token *> &tokens) {
-	std::vector<TypeKind> types;
-	types.reserve(tokens.size());
-	for (auto it = tokens.rbegin(); it != tokens.rend(); ++it) {
-		types.push_back(map_type((*it)->getText()));
+	//the scalar type is followed by the dimensions
+	Type type(map_type(tokens.front()->getText()));
+	for (auto it = std::next(tokens.begin()); it != tokens.end(); ++it) {
+		ASSERT(map_type((*it)->getText()) == TypeKind::ARR, "invalid type " + (*it)->getText());
+		type = array_of(type);
 	}
-
-	return Type(std::make_shared<std::vector<TypeKind>>(std::move(types)));
+	return type;
 }
 
-std::string Type::to_string() {
+std::string Type::to_string() const {
 	std::string str;
-	for (int i = pos; i < types->size(); i++) {
-		switch (types->at(i)) {
+	for (auto t = *this; t.length() > 0; t = t.dropType()) {
+		switch (t.getCurrentType()) {
 			case TypeKind::INT: {
 				str += "int";
 				break;
 			}
 			case TypeKind::STRING: {
-				str += "string";
-				break;
+				//the element chars aren't a part of the name
+				return str + "string";
 			}
 			case TypeKind::CHAR: {
 				str += "char";
@@ -90,61 +135,11 @@ std::string Type::to_string() {
 	return str;
 }
 
-Type::Type(TypeKind type) {
-	std::vector<TypeKind> vec = {type};
-	types = std::make_shared<std::vector<TypeKind>>(std::move(vec));
-}
-
-bool Type::operator==(const Type &rhs) const {
-	if (length() != rhs.length()) {
-		return false;
-	}
-	for (int i = 0; i < length(); i++) {
-		if (types->at(i + pos) != rhs.types->at(i + rhs.pos)) {
-			return false;
-		}
-	}
-	return true;
-}
-
-bool Type::operator!=(const Type &rhs) const {
-	return !operator==(rhs);
-}
-
-bool Type::operator==(const TypeKind &rhs) const {
-	if (length() > 1) {
-		return false;
-	}
-
-	return getCurrentType() == rhs;
-}
-
-bool Type::operator!=(const TypeKind &rhs) const {
-	return !operator==(rhs);
-}
-
 bool Type::type_is_numerical(TypeKind kind) {
 	return kind == TypeKind::CHAR || kind == TypeKind::INT;
 }
 
-bool Type::is_numerical() const {
-	return is_scalar() && type_is_numerical(getCurrentType());
-}
-
-bool Type::is_scalar() const {
-	return length() == 1 && *this != TypeKind::STRING;
-}
-
-int Type::length() const {
-	return (int)types->size() - pos;
-}
-
-bool Type::is_string() const {
-	return length() == 1 && getCurrentType() == TypeKind::STRING ||
-			length() == 2 && getCurrentType() == TypeKind::ARR && dropType() == TypeKind::CHAR;
-}
-
-bool Type::is_convertable_to(Type &other) const {
+bool Type::is_convertable_to(const Type &other) const {
 	return *this == other || is_numerical() && other.is_numerical() ||
 	 is_string() && other.is_string();
 }
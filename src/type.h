@@ -5,11 +5,16 @@
 #ifndef D_GEN_TYPE_H
 #define D_GEN_TYPE_H
 
+#include <atomic>
+#include <cstdint>
 #include <vector>
 #include <memory>
 
 #include "antlr4-runtime.h"
 
+//max number of different types of a process
+#define MAX_TYPES 4096
+
 enum class TypeKind {
 	INT,
 	STRING,
@@ -19,27 +24,89 @@ enum class TypeKind {
 	INVALID
 };
 
+//types are interned in a global table and a Type is the id of its entry,
+//so copies and comparisons are integer operations.
+//the entry of T[] refers to the entry of T, the element types of a string are chars
 class Type {
 public:
-	std::shared_ptr<std::vector<TypeKind>> types;
-	int pos = 0;
-	explicit Type(std::shared_ptr<std::vector<TypeKind>> types);
 	Type(TypeKind type);
-	TypeKind getCurrentType() const;
-	Type dropType() const;
+	//outermost kind: ARR for arrays
+	TypeKind getCurrentType() const {
+		return info().kind;
+	}
+	//type of the elements, INVALID for scalars
+	Type dropType() const {
+		return Type(info().elem);
+	}
 	static Type create(std::vector<antlr4::Token*> &tokens);
-	std::string to_string();
-	bool operator==(const Type& rhs) const;
-	bool operator!=(const Type& rhs) const;
-	bool operator==(const TypeKind& rhs) const;
-	bool operator!=(const TypeKind& rhs) const;
-	bool is_numerical() const;
-	bool is_scalar() const;
-	bool is_string() const;
-	bool is_convertable_to(Type &other) const;
-	int length() const;
+	static Type array_of(Type elem);
+	std::string to_string() const;
+	bool operator==(const Type& rhs) const {
+		return id == rhs.id;
+	}
+	bool operator!=(const Type& rhs) const {
+		return id != rhs.id;
+	}
+	bool operator==(const TypeKind& rhs) const {
+		return *this == Type(rhs);
+	}
+	bool operator!=(const TypeKind& rhs) const {
+		return !operator==(rhs);
+	}
+	bool is_numerical() const {
+		return is_scalar() && type_is_numerical(getCurrentType());
+	}
+	bool is_scalar() const {
+		return info().length == 1 && getCurrentType() != TypeKind::STRING;
+	}
+	bool is_string() const {
+		return id == STRING_ID || id == CHAR_ARR_ID;
+	}
+	bool is_convertable_to(const Type &other) const;
+	//levels of nesting, 1 for scalars and strings, 0 for INVALID
+	int length() const {
+		return info().length;
+	}
+	//kind of the innermost elements
+	TypeKind get_scalar_kind() const {
+		return info().scalar;
+	}
+	//of the native value: scalars are stored as is, arrays and strings as pointers
+	int get_sizeof() const {
+		return info().size;
+	}
+	uint32_t get_id() const {
+		return id;
+	}
 	static bool type_is_numerical(TypeKind kind);
 private:
+	enum : uint32_t {
+		INVALID_ID,
+		INT_ID,
+		STRING_ID,
+		CHAR_ID,
+		BOOL_ID,
+		CHAR_ARR_ID,
+		PREDEFINED_NUM
+	};
+
+	struct Info {
+		TypeKind kind;
+		uint32_t elem;
+		TypeKind scalar;
+		int length;
+		int size;
+		//id of the array of this type, 0 until it's interned
+		std::atomic<uint32_t> arr_of;
+	};
+	static Info table[MAX_TYPES];
+	static std::atomic<uint32_t> types_num;
+
+	uint32_t id;
+	explicit Type(uint32_t id): id(id) {}
+	const Info &info() const {
+		return table[id];
+	}
 	static TypeKind map_type(const std::string &type);
 };
 
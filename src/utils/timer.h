@@ -0,0 +1,35 @@
+//
+// Created by Anton on 17.10.2026.
+//
+
+#ifndef D_GEN_TIMER_H
+#define D_GEN_TIMER_H
+
+#include <chrono>
+#include <cstdint>
+
+//adds the wall time of the scope to dest in nanoseconds, exceptions included.
+//a disabled timer doesn't read the clock (for the timers on the path of every test)
+class ScopedTimer {
+public:
+	explicit ScopedTimer(uint64_t &dest, bool enabled = true): dest(dest), enabled(enabled) {
+		if (enabled) {
+			start = std::chrono::steady_clock::now();
+		}
+	}
+	~ScopedTimer() {
+		if (enabled) {
+			dest += std::chrono::duration_cast<std::chrono::nanoseconds>(
+					std::chrono::steady_clock::now() - start).count();
+		}
+	}
+
+	ScopedTimer(const ScopedTimer&) = delete;
+	ScopedTimer &operator=(const ScopedTimer&) = delete;
+private:
+	uint64_t &dest;
+	bool enabled;
+	std::chrono::steady_clock::time_point start;
+};
+
+#endif //D_GEN_TIMER_H
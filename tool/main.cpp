@@ -1,6 +1,9 @@
 #include <iostream>
 #include <stdexcept>
 #include <fstream>
+#include <cstring>
+#include <cstdlib>
+#include <iomanip>
 
 #include "d_gen/BuildError.h"
 #include "d_gen/DGen.h"
@@ -8,6 +11,9 @@
 char *prog_path = nullptr;
 std::optional<int> seed;
 std::optional<int> tests_num;
+int threads = 1;
+bool print_stats = false;
+ProgramOptions options;
 
 void parse_args(int argc, char *argv[]) {
 	for (int i = 1; i < argc; i++) {
@@ -21,6 +27,70 @@ void parse_args(int argc, char *argv[]) {
 			case 'n':
 				tests_num = std::atoi(argv[i]+2);
 				break;
+			case 'j':
+				threads = std::atoi(argv[i]+2);
+				break;
+			case 'b':
+				options.encoding = Z3Encoding::BIT_VECTOR;
+				break;
+			case 'O':
+				if (std::strcmp(argv[i]+2, "auto") == 0) {
+					options.opt_level = OptLevel::AUTO;
+				} else if (argv[i][2] >= '0' && argv[i][2] <= '3' && argv[i][3] == '\0') {
+					options.opt_level = (OptLevel)(argv[i][2] - '0');
+				} else {
+					std::cout << "warning: unknown optimization level " << argv[i]+2 << std::endl;
+				}
+				break;
+			case 'e':
+				if (std::strcmp(argv[i]+2, "interp") == 0) {
+					options.exec_mode = ExecMode::INTERPRETER;
+				} else if (std::strcmp(argv[i]+2, "tiered") == 0) {
+					options.exec_mode = ExecMode::TIERED;
+				} else if (std::strcmp(argv[i]+2, "jit") != 0) {
+					std::cout << "warning: unknown execution mode " << argv[i]+2 << std::endl;
+				}
+				break;
+			case 'l':
+				options.loop_budget = std::strtoull(argv[i]+2, nullptr, 10);
+				break;
+			case 't':
+				options.test_timeout_ms = std::atoi(argv[i]+2);
+				break;
+			case 'r':
+				options.abort_retries = std::atoi(argv[i]+2);
+				break;
+			case 'k':
+				options.bounds_checks = true;
+				break;
+			case 'g':
+				options.coverage_guided = true;
+				if (std::strcmp(argv[i]+2, "stop") == 0) {
+					options.stop_when_covered = true;
+				} else if (argv[i][2] != '\0') {
+					std::cout << "warning: unknown coverage option " << argv[i]+2 << std::endl;
+				}
+				break;
+			case 'c':
+				options.object_cache_dir = argv[i]+2;
+				break;
+			case '-':
+				if (std::strcmp(argv[i]+2, "stats") == 0) {
+					print_stats = true;
+					options.collect_stats = true;
+				} else {
+					std::cout << "warning: unknown parameter " << argv[i] << std::endl;
+				}
+				break;
+			case 'o':
+				if (std::strcmp(argv[i]+2, "bin") == 0) {
+					options.format = OutputFormat::BINARY;
+				} else if (std::strcmp(argv[i]+2, "col") == 0) {
+					options.format = OutputFormat::COLUMNAR;
+				} else if (std::strcmp(argv[i]+2, "json") != 0) {
+					std::cout << "warning: unknown format " << argv[i]+2 << std::endl;
+				}
+				break;
 			default:
 				std::cout << "warning: unknown parameter " << argv[i][1] << std::endl;
 				break;
@@ -29,7 +99,26 @@ void parse_args(int argc, char *argv[]) {
 }
 
 void print_usage(char *this_prog) {
-	std::cout << "usage: " << this_prog << " -f<path to program> -s<optional seed> -n<tests_num>" << std::endl;
+	std::cout << "usage: " << this_prog <<  " -f<path to program> -s<optional seed> -n<tests_num> -j<optional threads> -b(optional, bit vector constraints) -o<optional json|bin|col> -c<optional cache dir> -O<optional 0|1|2|3|auto> -e<optional jit|interp|tiered> -l<optional loop budget> -t<optional test timeout ms> -r<optional retries> -k(optional, bounds checks) -g<optional, coverage guided, stop> --stats(optional, conditions stats to stderr)" << std::endl;
+}
+
+void print_condition_stats(const std::vector<ConditionStats> &stats) {
+	std::cerr << std::left << std::setw(10) << "position" << std::right
+			  << std::setw(8) << "precond" << std::setw(12) << "executions"
+			  << std::setw(10) << "true" << std::setw(10) << "false"
+			  << std::setw(10) << "negated" << std::setw(10) << "skipped"
+			  << std::setw(12) << "cache hits" << std::setw(14) << "solver calls"
+			  << std::setw(14) << "solver ms" << std::setw(8) << "unsat"
+			  << std::setw(9) << "unknown" << std::endl;
+	for (const auto &s: stats) {
+		std::cerr << std::left << std::setw(10) << (std::to_string(s.line) + ":" + std::to_string(s.col)) << std::right
+				  << std::setw(8) << (s.has_precond ? "yes" : "no") << std::setw(12) << s.executions()
+				  << std::setw(10) << s.true_count << std::setw(10) << s.false_count
+				  << std::setw(10) << s.negated << std::setw(10) << s.skipped
+				  << std::setw(12) << s.cache_hits << std::setw(14) << s.solver_calls
+				  << std::setw(14) << std::fixed << std::setprecision(3) << s.solver_time_ns / 1e6
+				  << std::setw(8) << s.unsat << std::setw(9) << s.unknown << std::endl;
+	}
 }
 
 int main(int argc, char *argv[]) {
@@ -49,11 +138,28 @@ int main(int argc, char *argv[]) {
 			throw std::runtime_error("can't read file");
 		}
 
-		DGen d_gen(stream);
-		std::string json = d_gen.generate_json(*tests_num, seed);
+		DGen d_gen(stream, options);
 
-		std::cout << "generated tests:\n";
-		std::cout << json << std::endl;
+		//binary formats go to stdout as is
+		bool json = options.format == OutputFormat::JSON;
+		if (json) {
+			std::cout << "generated tests:\n";
+		}
+		OStreamSink sink(std::cout);
+		d_gen.generate_json(*tests_num, seed, sink, threads);
+		if (json) {
+			std::cout << std::endl;
+		}
+		auto limit_stats = d_gen.compile().test_limit_stats();
+		if (limit_stats.dropped > 0) {
+			std::cerr << "warning: " << limit_stats.dropped << " tests were dropped ("
+					  << limit_stats.retries << " retries; aborted: " << limit_stats.over_budget << " over the budget, "
+					  << limit_stats.timed_out << " timed out, " << limit_stats.out_of_bounds << " out of bounds)"
+					  << std::endl;
+		}
+		if (print_stats) {
+			print_condition_stats(d_gen.condition_stats());
+		}
 		stream.close();
 	} catch (const BuildError &err) {
 		std::cout << "errors" << std::endl;